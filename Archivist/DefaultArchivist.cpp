@@ -12,6 +12,8 @@
 
 #include<limits>
 
+#include "../Utilities/BinarySnapshot.h"
+
 ////// ARCHIVIST-outputMethod is actually set by Modules.h //////
 std::shared_ptr<ParameterLink<std::string>>
     DefaultArchivist::Arch_outputMethodStrPL = Parameters::register_parameter(
@@ -73,6 +75,21 @@ std::shared_ptr<ParameterLink<bool>>
             "ARCHIVIST_DEFAULT-writeSnapshotOrganismsFiles", false,
             "if true, snapshot organisms files will be written (with all "
             "organisms for entire population)");
+std::shared_ptr<ParameterLink<std::string>>
+    DefaultArchivist::SS_Arch_organismsFormatPL =
+        Parameters::register_parameter(
+            "ARCHIVIST_DEFAULT-snapshotOrganismsFormat", std::string("csv"),
+            "format of snapshot organisms files: csv or binary. binary files "
+            "(.bin) hold one bit-packed genome per organism and its numeric "
+            "data, and need organisms with one genome of int, bool or "
+            "unsigned char sites, and brains built from that genome");
+std::shared_ptr<ParameterLink<std::string>>
+    DefaultArchivist::SS_Arch_organismsColumnsPL =
+        Parameters::register_parameter(
+            "ARCHIVIST_DEFAULT-snapshotOrganismsColumns", std::string(""),
+            "numeric data saved with each organism in binary snapshot "
+            "organisms files (comma separated list of data names, averaged "
+            "if they are lists)");
 
 DefaultArchivist::DefaultArchivist(std::shared_ptr<ParametersTable> PT_,
                                    const std::string & group_prefix)
@@ -117,6 +134,16 @@ DefaultArchivist::DefaultArchivist(std::shared_ptr<ParametersTable> PT_,
 
   writeSnapshotDataFiles = SS_Arch_writeDataFilesPL->get(PT);
   writeSnapshotGenomeFiles = SS_Arch_writeOrganismsFilesPL->get(PT);
+  std::string organismsFormat = SS_Arch_organismsFormatPL->get(PT);
+  if (organismsFormat != "csv" && organismsFormat != "binary") {
+    std::cout << "  ERROR :: ARCHIVIST_DEFAULT-snapshotOrganismsFormat must be "
+                 "csv or binary, but is \""
+              << organismsFormat << "\". Exiting." << std::endl;
+    exit(1);
+  }
+  binarySnapshotOrganisms = organismsFormat == "binary";
+  convertCSVListToVector(SS_Arch_organismsColumnsPL->get(PT),
+                         binarySnapshotColumns);
 
 
   if (writePopFile || writeMaxFile ) 
@@ -151,6 +178,7 @@ DefaultArchivist::DefaultArchivist(std::vector<std::string> & popFileColumns,
 
   convertCSVListToVector(PopFileColumnNames, default_pop_file_columns_);
   max_formula_ = std::move(max_formula);
+  compiled_max_formula_ = CompiledMTree(max_formula_);
 
   if (default_pop_file_columns_.empty()) // hack because somehow getting passed empty string
     default_pop_file_columns_ = popFileColumns;
@@ -185,14 +213,21 @@ void DefaultArchivist::writeRealTimeFiles(
 
   if (writePopFile) {
     DataMap PopMap;
+    std::vector<double> values; // one value per organism for one column
     for (auto &kv : unique_column_name_to_output_behaviors_) {
-      if (kv.first != "update")
+      auto key = DataMap::keyOf(kv.first);
+      if (kv.first != "update") {
+        values.clear();
         for (auto const &org : population)
           if (org->timeOfBirth < Global::update || save_new_orgs_)
-            PopMap.append(kv.first, org->dataMap.getAverage(kv.first));
+            values.push_back(org->dataMap.getAverage(key));
+        if (!values.empty())
+          PopMap.set(key, values);
+      }
 
-      PopMap.setOutputBehavior(kv.first, kv.second);
+      PopMap.setOutputBehavior(key, kv.second);
     }
+    PopMap.merge(popFileStats);
     PopMap.set("update", Global::update);
     PopMap.writeToFile(
         PopFileName, {}); // write the PopMap to file with empty list (save all)
@@ -201,15 +236,21 @@ void DefaultArchivist::writeRealTimeFiles(
   // write out Max data
   if (writeMaxFile && max_formula_ != nullptr) {
 
-    std::shared_ptr<Organism> best_org;
-    auto score = std::numeric_limits<double>::lowest();
+    std::vector<std::shared_ptr<Organism>> candidates;
+    max_candidates_.clear();
     for (auto const &org : population)
       if (org->timeOfBirth < Global::update || save_new_orgs_) {
-        auto sc = max_formula_->eval(org->dataMap, org->PT)[0];
-        if (sc > score) {
-          score = sc;
-          best_org = org;
-        }
+        candidates.push_back(org);
+        max_candidates_.push_back(&org->dataMap);
+      }
+    compiled_max_formula_.evalAll(max_candidates_, PT, max_scores_);
+
+    std::shared_ptr<Organism> best_org;
+    auto score = std::numeric_limits<double>::lowest();
+    for (size_t i = 0; i < candidates.size(); i++)
+      if (max_scores_[i] > score) {
+        score = max_scores_[i];
+        best_org = candidates[i];
       }
 
     if (score == std::numeric_limits<double>::lowest()) {
@@ -386,6 +427,10 @@ void DefaultArchivist::resolveAncestors(
 
 void DefaultArchivist::saveSnapshotOrganisms(
     std::vector<std::shared_ptr<Organism>> & population) {
+  if (binarySnapshotOrganisms) {
+    saveSnapshotOrganismsBinary(population);
+    return;
+  }
   // write out organims
   std::string organismFileName =
       OrganismFilePrefix + "_" + std::to_string(Global::update) + ".csv";
@@ -412,9 +457,105 @@ void DefaultArchivist::saveSnapshotOrganisms(
                                             // again.
 }
 
+void DefaultArchivist::saveSnapshotOrganismsBinary(
+    std::vector<std::shared_ptr<Organism>> & population) {
+  std::string organismFileName =
+      OrganismFilePrefix + "_" + std::to_string(Global::update) + ".bin";
+
+  std::vector<std::shared_ptr<Organism>> saveList;
+  for (auto const &org : population) {
+    if (org->timeOfBirth < Global::update || save_new_orgs_) {
+      saveList.push_back(org);
+    }
+  }
+  if (saveList.empty()) {
+    return;
+  }
+
+  // the header is taken from the first organism; all others must match it
+  BinarySnapshot::Header header;
+  auto const &first = saveList[0];
+  if (first->genomes.size() != 1) {
+    std::cout << "  ERROR :: binary snapshot organisms files hold exactly one "
+                 "genome per organism, but organisms have "
+              << first->genomes.size() << ". Exiting." << std::endl;
+    exit(1);
+  }
+  header.genomeName = first->genomes.begin()->first;
+  header.alphabetSize =
+      (uint32_t)first->genomes.begin()->second->getAlphabetSize();
+  header.populationSize = saveList.size();
+  header.columns = binarySnapshotColumns;
+  std::vector<std::vector<uint32_t>> sites(saveList.size());
+  for (size_t i = 0; i < saveList.size(); i++) {
+    auto const &org = saveList[i];
+    auto genome = org->genomes.find(header.genomeName);
+    if (org->genomes.size() != 1 || genome == org->genomes.end() ||
+        !genome->second->getSiteValues(sites[i])) {
+      std::cout << "  ERROR :: organism " << org->ID
+                << " can not be written to a binary snapshot organisms file "
+                   "(it needs one genome named "
+                << header.genomeName << " with int, bool or unsigned char "
+                << "sites). Exiting." << std::endl;
+      exit(1);
+    }
+    for (auto const &brain : org->brains) {
+      std::string tempName = "BRAIN_" + brain.first;
+      if (!brain.second->serialize(tempName).getKeys().empty()) {
+        std::cout << "  ERROR :: brain " << brain.first
+                  << " saves its own data, which binary snapshot organisms "
+                     "files can not hold. Exiting."
+                  << std::endl;
+        exit(1);
+      }
+    }
+    header.genomeLength =
+        std::max(header.genomeLength, (uint64_t)sites[i].size());
+  }
+
+  BinarySnapshot::Writer writer;
+  if (!writer.open(organismFileName, header)) {
+    std::cout << "  ERROR :: could not open " << organismFileName
+              << " for writing. Exiting." << std::endl;
+    exit(1);
+  }
+  std::vector<double> values(header.columns.size());
+  for (size_t i = 0; i < saveList.size(); i++) {
+    auto &dataMap = saveList[i]->dataMap;
+    for (size_t c = 0; c < header.columns.size(); c++) {
+      auto typeName =
+          dataMap.lookupDataMapTypeName(dataMap.findKeyInData(header.columns[c]));
+      values[c] = typeName == "none" || typeName == "string"
+                      ? std::numeric_limits<double>::quiet_NaN()
+                      : dataMap.getAverage(header.columns[c]);
+    }
+    writer.write(saveList[i]->ID, sites[i], values);
+  }
+  if (!writer.close()) {
+    std::cout << "  ERROR :: could not write " << organismFileName
+              << ". Exiting." << std::endl;
+    exit(1);
+  }
+}
+
 void DefaultArchivist::writeDefArchFiles(
     std::vector<std::shared_ptr<Organism>> &population) {
 
+  // a run resumed from a checkpoint starts part way through the sequences
+  while (realtimeSequence[realtime_sequence_index_] != -1 &&
+         realtimeSequence[realtime_sequence_index_] < Global::update) {
+    realtime_sequence_index_++;
+  }
+  while (realtimeDataSequence[realtime_data_seq_index_] != -1 &&
+         realtimeDataSequence[realtime_data_seq_index_] < Global::update) {
+    realtime_data_seq_index_++;
+  }
+  while (realtimeOrganismSequence[realtime_organism_seq_index_] != -1 &&
+         realtimeOrganismSequence[realtime_organism_seq_index_] <
+             Global::update) {
+    realtime_organism_seq_index_++;
+  }
+
   if (Global::update ==
       realtimeSequence[realtime_sequence_index_]) {
     writeRealTimeFiles(population); // write to Max and Pop files
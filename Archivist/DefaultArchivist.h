@@ -39,6 +39,9 @@ public:
   std::string OrganismFilePrefix; // name of the Genome file (genomes on LOD)
   bool writeSnapshotDataFiles;    // if true, write data file
   bool writeSnapshotGenomeFiles;  // if true, write genome file
+  bool binarySnapshotOrganisms;   // if true, genome files are binary
+  std::vector<std::string> binarySnapshotColumns; // data saved in binary
+                                                  // genome files
 
   std::vector<int> realtimeSequence; // how often to write out data
   std::vector<int> realtimeDataSequence;
@@ -52,6 +55,9 @@ public:
   std::shared_ptr<Abstract_MTree>
       max_formula_; // what value will be used to determine
                     // which organism to write to max file
+  CompiledMTree compiled_max_formula_;
+  std::vector<DataMap *> max_candidates_; // scratch for writeRealTimeFiles
+  std::vector<double> max_scores_;
 
   bool save_new_orgs_ = false;
 
@@ -63,6 +69,10 @@ public:
 
   std::map<std::string, int> unique_column_name_to_output_behaviors_;
 
+  // values that belong to the run rather than to any organism (set by a
+  // world each update, say); each pop file row gets their current values
+  DataMap popFileStats;
+
   bool finished_ =
       false; // if finished, then as far as the archivist is concerned, we
              // can stop the run.
@@ -83,6 +93,10 @@ public:
   void saveSnapshotOrganisms(
       std::vector<std::shared_ptr<Organism>> & /*population*/);
 
+  // write organisms in the binary format (see Utilities/BinarySnapshot.h)
+  void saveSnapshotOrganismsBinary(
+      std::vector<std::shared_ptr<Organism>> & /*population*/);
+
   void saveOrgToFile(const std::shared_ptr<Organism> &/*org*/,
                      const std::string & /*data_file_name*/);
 
@@ -117,6 +131,10 @@ public:
       SS_Arch_writeDataFilesPL; // if true, write data file
   static std::shared_ptr<ParameterLink<bool>>
       SS_Arch_writeOrganismsFilesPL; // if true, write genome file
+  static std::shared_ptr<ParameterLink<std::string>>
+      SS_Arch_organismsFormatPL; // csv or binary genome files
+  static std::shared_ptr<ParameterLink<std::string>>
+      SS_Arch_organismsColumnsPL; // data saved in binary genome files
 
   DefaultArchivist(std::shared_ptr<ParametersTable> /*PT*/ = nullptr,
                    const std::string & /*_groupPrefix*/ = "");
@@ -9,6 +9,7 @@
 //         github.com/Hintzelab/MABE/wiki/License
 
 #include "../ConstantValuesBrain/ConstantValuesBrain.h"
+#include "../../Genome/CircularGenome/CircularGenome.h"
 
 std::shared_ptr<ParameterLink<double>> ConstantValuesBrain::valueMinPL =
     Parameters::register_parameter("BRAIN_CONSTANT-valueMin", 0.0,
@@ -45,10 +46,24 @@ std::shared_ptr<ParameterLink<std::string>> ConstantValuesBrain::genomeNamePL =
                                    "namespace used to set parameters for "
                                    "genome used to encode this brain");
 
+ConstantValuesBrainSettings::ConstantValuesBrainSettings(
+    std::shared_ptr<ParametersTable> PT_)
+    : bindings("ConstantValuesBrain", PT_) {
+  bindings.bind(valueMin, ConstantValuesBrain::valueMinPL);
+  bindings.bind(valueMax, ConstantValuesBrain::valueMaxPL);
+  bindings.bind(valueType, ConstantValuesBrain::valueTypePL);
+  bindings.bind(samplesPerValue, ConstantValuesBrain::samplesPerValuePL);
+  bindings.bind(genomeName, ConstantValuesBrain::genomeNamePL);
+}
+
 ConstantValuesBrain::ConstantValuesBrain(int _nrInNodes, int _nrOutNodes,
                                          std::shared_ptr<ParametersTable> PT_)
     : AbstractBrain(_nrInNodes, _nrOutNodes, PT_) {
 
+  if (PT != nullptr) {
+    settings = SharedParameters<ConstantValuesBrainSettings>::get(PT);
+  }
+
   // columns to be added to ave file
   popFileColumns.clear();
   for (int i = 0; i < nrOutputValues; i++) {
@@ -60,13 +75,20 @@ std::shared_ptr<AbstractBrain> ConstantValuesBrain::makeBrain(
     std::unordered_map<std::string, std::shared_ptr<AbstractGenome>>
         &_genomes) {
   std::shared_ptr<ConstantValuesBrain> newBrain =
-      std::make_shared<ConstantValuesBrain>(nrInputValues, nrOutputValues, PT);
-  auto genomeHandler = _genomes[genomeNamePL->get(PT)]->newHandler(
-      _genomes[genomeNamePL->get(PT)], true);
-  auto samplesPerValue = samplesPerValuePL->get(PT);
-  auto valueType = valueTypePL->get(PT);
-  auto valueMin = valueMinPL->get(PT);
-  auto valueMax = valueMaxPL->get(PT);
+      pool().get([this](const ConstantValuesBrain &brain) {
+        return brain.PT == PT && brain.nrInputValues == nrInputValues &&
+               brain.nrOutputValues == nrOutputValues;
+      });
+  if (newBrain == nullptr) {
+    newBrain = pool().adopt(
+        new ConstantValuesBrain(nrInputValues, nrOutputValues, PT));
+  }
+  auto &genome = _genomes[settings->genomeName];
+  auto genomeHandler = genome->newHandler(genome, true);
+  auto samplesPerValue = settings->samplesPerValue;
+  auto valueType = settings->valueType;
+  auto valueMin = settings->valueMin;
+  auto valueMax = settings->valueMax;
 
   if (valueType != 0 && valueType!= 1) {
         std::cout
@@ -75,6 +97,32 @@ std::shared_ptr<AbstractBrain> ConstantValuesBrain::makeBrain(
         exit(1);
   }
 
+  // values that can only be 0 or 1 are stored as bits
+  if (valueType == 0 && valueMin == 0 && valueMax == 1) {
+    newBrain->usePackedValues();
+    // with one sample per value from a binary circular genome, value i is 
+    // just site i, so the bits can be copied over without a handler
+    auto boolGenome = std::dynamic_pointer_cast<CircularGenome<bool>>(genome);
+    if (samplesPerValue == 1 && boolGenome != nullptr &&
+        boolGenome->alphabetSize == 2) {
+      boolGenome->packSites(newBrain->packedValues, nrOutputValues);
+      return newBrain;
+    }
+    for (int i = 0; i < nrOutputValues; i++) {
+      auto tempValue = 0.;
+      for (int j = 0; j < samplesPerValue; j++)
+        tempValue += genomeHandler->readInt(valueMin, valueMax);
+      PackedBits::setBit(newBrain->packedValues.data(), i,
+                         int(tempValue / samplesPerValue) != 0);
+    }
+    return newBrain;
+  }
+
+  if (newBrain->packed) { // a reused brain that was packed
+    newBrain->packed = false;
+    newBrain->packedValues.clear();
+    newBrain->outputValues.assign(nrOutputValues, 0.0);
+  }
   for (int i = 0; i < nrOutputValues; i++) {
     auto tempValue = 0.;
     for (int j = 0; j < samplesPerValue; j++) 
@@ -88,6 +136,13 @@ std::shared_ptr<AbstractBrain> ConstantValuesBrain::makeBrain(
   return newBrain;
 }
 
+void ConstantValuesBrain::usePackedValues() {
+  packed = true;
+  packedValues.assign(PackedBits::wordCount(nrOutputValues), 0);
+  outputValues.clear();
+  outputValues.shrink_to_fit();
+}
+
 void ConstantValuesBrain::resetBrain() {
   // do nothing! values never change!
 }
@@ -107,7 +162,7 @@ std::string ConstantValuesBrain::description() {
 DataMap ConstantValuesBrain::getStats(std::string &prefix) {
   DataMap dataMap;
   for (int i = 0; i < nrOutputValues; i++) {
-    dataMap.set(prefix + "brainValue" + std::to_string(i), outputValues[i]);
+    dataMap.set(prefix + "brainValue" + std::to_string(i), readOutput(i));
   }
   return dataMap;
 }
@@ -186,6 +241,11 @@ ConstantValuesBrain::makeCopy(std::shared_ptr<ParametersTable> PT_) {
   auto newBrain =
       std::make_shared<ConstantValuesBrain>(nrInputValues, nrOutputValues, PT_);
 
+  if (packed) {
+    newBrain->usePackedValues();
+    newBrain->packedValues = packedValues;
+    return newBrain;
+  }
   for (int i = 0; i < nrOutputValues; i++) {
     newBrain->outputValues[i] = outputValues[i];
   }
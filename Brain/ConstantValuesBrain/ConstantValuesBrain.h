@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <iostream>
@@ -17,11 +18,28 @@
 #include <vector>
 
 #include "../../Genome/AbstractGenome.h"
+#include "../../Utilities/ObjectPool.h"
 
+#include "../../Utilities/PackedBits.h"
+#include "../../Utilities/ParameterBindings.h"
 #include "../../Utilities/Random.h"
 
 #include "../AbstractBrain.h"
 
+// parameters read by makeBrain, shared by every brain made with the same
+// ParametersTable (see Utilities/ParameterBindings.h)
+class ConstantValuesBrainSettings {
+public:
+  ParameterBindings bindings;
+  double valueMin;
+  double valueMax;
+  int valueType;
+  int samplesPerValue;
+  std::string genomeName;
+
+  ConstantValuesBrainSettings(std::shared_ptr<ParametersTable> PT_);
+};
+
 class ConstantValuesBrain : public AbstractBrain {
 public:
   static std::shared_ptr<ParameterLink<double>> valueMinPL;
@@ -35,6 +53,13 @@ public:
 
   static std::shared_ptr<ParameterLink<std::string>> genomeNamePL;
 
+  // when every value is an int in [0,1] the values are kept one bit each in
+  // packedValues and outputValues is left empty
+  bool packed = false;
+  std::vector<uint64_t> packedValues;
+
+  std::shared_ptr<const ConstantValuesBrainSettings> settings;
+
   ConstantValuesBrain() = delete;
 
   ConstantValuesBrain(int _nrInNodes, int _nrOutNodes,
@@ -59,6 +84,52 @@ public:
   virtual void resetBrain() override;
   virtual void resetOutputs() override;
 
+  virtual double readOutput(const int &outputAddress) override {
+    if (!packed) {
+      return AbstractBrain::readOutput(outputAddress);
+    }
+    if (outputAddress >= nrOutputValues) {
+      std::cout << "in ConstantValuesBrain::readOutput() : Reading from invalid "
+                   "output (" << outputAddress
+                << ") - this brain needs more outputs!\nExiting" << std::endl;
+      exit(1);
+    }
+    return PackedBits::getBit(packedValues.data(), outputAddress);
+  }
+
+  virtual void setOutput(const int &outputAddress, const double &value) override {
+    if (!packed) {
+      AbstractBrain::setOutput(outputAddress, value);
+      return;
+    }
+    if (outputAddress >= nrOutputValues) {
+      std::cout << "in ConstantValuesBrain::setOutput() : Writing to invalid "
+                   "output (" << outputAddress
+                << ") - this brain needs more outputs!\nExiting" << std::endl;
+      exit(1);
+    }
+    PackedBits::setBit(packedValues.data(), outputAddress, int(value) != 0);
+  }
+
+  // packed values, or nullptr if values are stored as doubles
+  const std::vector<uint64_t> *getPackedValues() {
+    return packed ? &packedValues : nullptr;
+  }
+
+  // switch to packed storage (all values start at 0)
+  void usePackedValues();
+
+  // brains that are no longer used, kept so makeBrain can reuse them (see
+  // Utilities/ObjectPool.h)
+  static ObjectPool<ConstantValuesBrain> &pool() {
+    return ObjectPool<ConstantValuesBrain>::instance("constantValuesBrain");
+  }
+  // called by pool() when a brain is no longer used
+  void recycle() {
+    std::fill(inputValues.begin(), inputValues.end(), 0.0);
+    recordActivity = false;
+  }
+
   virtual std::shared_ptr<AbstractBrain>
   makeCopy(std::shared_ptr<ParametersTable> PT_ = nullptr) override;
 
@@ -182,6 +182,22 @@ public:
     exit(1);
   }
 
+  // write and read state that serialize does not cover (e.g. counters
+  // inherited from parent genomes) so a checkpointed run can be resumed
+  // the undefined action is to have no such state
+  virtual void saveCheckpoint(Checkpoint::Writer &checkpoint) {}
+  virtual void loadCheckpoint(Checkpoint::Reader &checkpoint) {}
+
+  // copy the sites of this genome into values as integers in
+  // [0, alphabetSize), for writing binary snapshots
+  // the undefined action is to return false (sites are not integers)
+  virtual bool getSiteValues(std::vector<uint32_t> &values) { return false; }
+
+  // replace the sites of this genome with values (as getSiteValues gives
+  // them), for loading binary snapshots
+  // the undefined action is to return false (sites are not integers)
+  virtual bool setSiteValues(const std::vector<uint32_t> &values) { return false; }
+
   virtual std::string genomeToStr() {
     std::cout << "Warning! In AbstractGenome::genomeToStr()...\n";
     return "";
@@ -35,6 +35,26 @@ std::shared_ptr<ParameterLink<int>> CircularGenomeParameters::mutationCrossCount
 std::shared_ptr<ParameterLink<double>> CircularGenomeParameters::mutationPointOffsetRatePL = Parameters::register_parameter("GENOME_CIRCULAR-mutationPointOffsetRate", 0.0, "per site point offset mutation rate (site changes in range (+/-)mutationPointOffsetRange)");
 std::shared_ptr<ParameterLink<double>> CircularGenomeParameters::mutationPointOffsetRangePL = Parameters::register_parameter("GENOME_CIRCULAR-mutationPointOffsetRange", 1.0, "range of PointOffset mutation");
 
+CircularGenomeSettings::CircularGenomeSettings(std::shared_ptr<ParametersTable> PT_) : bindings("CircularGenome", PT_) {
+	bindings.bind(mutationPointRate, CircularGenomeParameters::mutationPointRatePL);
+	bindings.bind(mutationPointOffsetRate, CircularGenomeParameters::mutationPointOffsetRatePL);
+	bindings.bind(mutationPointOffsetRange, CircularGenomeParameters::mutationPointOffsetRangePL);
+	bindings.bind(mutationCopyRate, CircularGenomeParameters::mutationCopyRatePL);
+	bindings.bind(mutationCopyMinSize, CircularGenomeParameters::mutationCopyMinSizePL);
+	bindings.bind(mutationCopyMaxSize, CircularGenomeParameters::mutationCopyMaxSizePL);
+	bindings.bind(mutationDeleteRate, CircularGenomeParameters::mutationDeleteRatePL);
+	bindings.bind(mutationDeleteMinSize, CircularGenomeParameters::mutationDeleteMinSizePL);
+	bindings.bind(mutationDeleteMaxSize, CircularGenomeParameters::mutationDeleteMaxSizePL);
+	bindings.bind(sizeMax, CircularGenomeParameters::sizeMaxPL);
+	bindings.bind(sizeMin, CircularGenomeParameters::sizeMinPL);
+	bindings.bind(mutationCrossCount, CircularGenomeParameters::mutationCrossCountPL);
+	bindings.bind(mutationIndelRate, CircularGenomeParameters::mutationIndelRatePL);
+	bindings.bind(mutationIndelMinSize, CircularGenomeParameters::mutationIndelMinSizePL);
+	bindings.bind(mutationIndelMaxSize, CircularGenomeParameters::mutationIndelMaxSizePL);
+	bindings.bind(mutationIndelInsertMethod, CircularGenomeParameters::mutationIndelInsertMethodPL);
+	bindings.bind(mutationIndelCopyFirst, CircularGenomeParameters::mutationIndelCopyFirstPL);
+}
+
 
 // constructor
 template<class T>
@@ -352,6 +372,9 @@ std::vector<std::vector<int>> CircularGenome<T>::Handler::readTable(std::pair<in
 
 template<class T>
 void CircularGenome<T>::setupCircularGenome(int _size, double _alphabetSize) {
+	if (PT != nullptr) {
+		settings = SharedParameters<CircularGenomeSettings>::get(PT);
+	}
 	sites.resize(_size);
 	alphabetSize = _alphabetSize;
 	// define columns to be written to genome files
@@ -500,10 +523,7 @@ template<class T>
 void CircularGenome<T>::copyFrom(std::shared_ptr<AbstractGenome> from) {
 	auto castFrom = std::dynamic_pointer_cast<CircularGenome<T>>(from);  // we will be pulling all sorts of stuff from this genome so lets just cast it once.
 	alphabetSize = castFrom->alphabetSize;
-	sites.clear();
-	for (auto site : castFrom->sites) {
-		sites.push_back(site);
-	}
+	sites = castFrom->sites;
 	countPoint = castFrom->countPoint;
 	countPointOffset = castFrom->countPointOffset;
 	countDelete = castFrom->countDelete;
@@ -590,26 +610,26 @@ int CircularGenome<T>::incrementIndel() {
 // apply mutations to this genome
 template<class T>
 void CircularGenome<T>::mutate() {
-	int howManyPoint = Random::getBinomial((int)sites.size(), CircularGenomeParameters::mutationPointRatePL->get(PT));
-	int howManyPointOffset = Random::getBinomial((int)sites.size(), CircularGenomeParameters::mutationPointOffsetRatePL->get(PT));
-	int howManyCopy = Random::getBinomial((int)sites.size(), CircularGenomeParameters::mutationCopyRatePL->get(PT));
-	int howManyDelete = Random::getBinomial((int)sites.size(), CircularGenomeParameters::mutationDeleteRatePL->get(PT));
-	int howManyIndel = Random::getBinomial((int)sites.size(), CircularGenomeParameters::mutationIndelRatePL->get(PT));
+	int howManyPoint = Random::getBinomial((int)sites.size(), settings->mutationPointRate);
+	int howManyPointOffset = Random::getBinomial((int)sites.size(), settings->mutationPointOffsetRate);
+	int howManyCopy = Random::getBinomial((int)sites.size(), settings->mutationCopyRate);
+	int howManyDelete = Random::getBinomial((int)sites.size(), settings->mutationDeleteRate);
+	int howManyIndel = Random::getBinomial((int)sites.size(), settings->mutationIndelRate);
 	// do some point mutations
 	for (int i = 0; i < howManyPoint; i++) {
 		pointMutate();
 		incrementPoint();
 	}
 	// do some pointOffset mutations
-	double pointOffsetRange = CircularGenomeParameters::mutationPointOffsetRangePL->get(PT);
+	double pointOffsetRange = settings->mutationPointOffsetRange;
 	for (int i = 0; i < howManyPointOffset; i++) {
 		pointMutate(pointOffsetRange);
 		incrementPointOffset();
 	}
 	// do some copy mutations
-	int MaxGenomeSize = CircularGenomeParameters::sizeMaxPL->get(PT);
-	int IMax = CircularGenomeParameters::mutationCopyMaxSizePL->get(PT);
-	int IMin = CircularGenomeParameters::mutationCopyMinSizePL->get(PT);
+	int MaxGenomeSize = settings->sizeMax;
+	int IMax = settings->mutationCopyMaxSize;
+	int IMin = settings->mutationCopyMinSize;
 	for (int i = 0; (i < howManyCopy) && (((int)sites.size()) < MaxGenomeSize); i++) {
 		//chromosome->mutateCopy(PT.lookup("mutationCopyMinSize"), PT.lookup("mutationCopyMaxSize"), PT.lookup("chromosomeSizeMax"));
 
@@ -638,9 +658,9 @@ void CircularGenome<T>::mutate() {
 		incrementCopy();
 	}
 	// do some deletion mutations
-	int MinGenomeSize = CircularGenomeParameters::sizeMinPL->get(PT);
-	int DMax = CircularGenomeParameters::mutationDeleteMaxSizePL->get(PT);
-	int DMin = CircularGenomeParameters::mutationDeleteMinSizePL->get(PT);
+	int MinGenomeSize = settings->sizeMin;
+	int DMax = settings->mutationDeleteMaxSize;
+	int DMin = settings->mutationDeleteMinSize;
 	for (int i = 0; (i < howManyDelete) && (((int)sites.size()) > MinGenomeSize); i++) {
 		//chromosome->mutateDelete(PT.lookup("mutationDeletionMinSize"), PT.lookup("mutationDeletionMaxSize"), PT.lookup("chromosomeSizeMin"));
 
@@ -658,10 +678,10 @@ void CircularGenome<T>::mutate() {
 		incrementDelete();
 	}
 	// do some combination insertion-deletion (indel) mutations
-	int IDMax = CircularGenomeParameters::mutationIndelMaxSizePL->get(PT);
-	int IDMin = CircularGenomeParameters::mutationIndelMinSizePL->get(PT);
-	bool copyFirst = CircularGenomeParameters::mutationIndelCopyFirstPL->get(PT);
-	int insertMethod = CircularGenomeParameters::mutationIndelInsertMethodPL->get(PT);
+	int IDMax = settings->mutationIndelMaxSize;
+	int IDMin = settings->mutationIndelMinSize;
+	bool copyFirst = settings->mutationIndelCopyFirst;
+	int insertMethod = settings->mutationIndelInsertMethod;
 
 	for (int i = 0; i < howManyIndel; i++) {
 
@@ -736,7 +756,10 @@ void CircularGenome<T>::mutate() {
 // inherit the ParamatersTable from the calling instance
 template<class T>
 std::shared_ptr<AbstractGenome> CircularGenome<T>::makeMutatedGenomeFrom(std::shared_ptr<AbstractGenome> parent) {
-	auto newGenome = std::make_shared<CircularGenome<T>>(PT);
+	auto newGenome = getPooled();
+	if (newGenome == nullptr) {
+		newGenome = pool().adopt(new CircularGenome<T>(PT));
+	}
 	newGenome->copyFrom(parent);
     newGenome->mutate();
 	newGenome->recordDataMap();
@@ -756,7 +779,11 @@ std::shared_ptr<AbstractGenome> CircularGenome<T>::makeMutatedGenomeFromMany(std
 	// first, check to make sure that parent genomes are conpatable.
 	auto castParent0 = std::dynamic_pointer_cast<CircularGenome<T>>(parents[0]);  // we will be pulling all sorts of stuff from this genome so lets just cast it once.
 
-	auto newGenome = std::make_shared<CircularGenome<T>>(castParent0->alphabetSize,0,PT);
+	auto newGenome = getPooled();
+	if (newGenome == nullptr) {
+		newGenome = pool().adopt(new CircularGenome<T>(castParent0->alphabetSize, 0, PT));
+	}
+	newGenome->alphabetSize = castParent0->alphabetSize;
 	//newGenome->alphabetSize = castParent0->alphabetSize;
 
 //	vector<std::shared_ptr<AbstractChromosome>> parentChromosomes;
@@ -784,7 +811,7 @@ std::shared_ptr<AbstractGenome> CircularGenome<T>::makeMutatedGenomeFromMany(std
 
 		// randomly determine crossCount number crossLocations
 		std::vector<double> crossLocations;
-		int crossCount = CircularGenomeParameters::mutationCrossCountPL->get(PT);
+		int crossCount = settings->mutationCrossCount;
 		for (int i = 0; i < crossCount; i++) {  // get some cross locations (% of length of chromosome)
 			crossLocations.push_back(Random::getDouble(1.0));
 		}
@@ -849,12 +876,40 @@ DataMap CircularGenome<T>::serialize(std::string& name) {
 	return serialDataMap;
 }
 
+// split allSites on ',' into genomeLength values (whitespace is ignored, as
+// it was when sites were read from a stream). Single digits, which is how
+// integer sites are written, are converted directly; anything else goes
+// through convertString. A missing or bad field repeats the previous value.
+template<class V>
+static void parseSites(const std::string& allSites, int genomeLength, std::vector<V>& values) {
+	values.clear();
+	values.reserve(genomeLength);
+	V value = V();
+	std::string field;
+	size_t pos = 0;
+	for (int i = 0; i < genomeLength; i++) {
+		field.clear();
+		while (pos < allSites.size() && allSites[pos] != ',') {
+			if (!isspace((unsigned char)allSites[pos])) {
+				field += allSites[pos];
+			}
+			pos++;
+		}
+		pos++; // skip the ','
+		if (std::is_integral<V>::value && field.size() == 1 && field[0] >= '0' &&
+		    field[0] <= (std::is_same<V, bool>::value ? '1' : '9')) {
+			value = (V)(field[0] - '0');
+		}
+		else {
+			convertString(field, value);
+		}
+		values.push_back(value);
+	}
+}
+
 // given a DataMap and PT, return genome [name] from the DataMap
 template<class T>
 void CircularGenome<T>::deserialize(std::shared_ptr<ParametersTable> PT, std::unordered_map<std::string, std::string>& orgData, std::string& name) {
-	char nextChar;
-	std::string nextString;
-	T value;
 	// make sure that data has needed columns
 	if (orgData.find("GENOME_" + name + "_sites") == orgData.end() || orgData.find("GENOME_" + name + "_genomeLength") == orgData.end()) {
 		std::cout << "  In CircularGenome<T>::deserialize :: can not find either GENOME_" + name + "_sites or GENOME_" + name + "_genomeLength.\n  exiting" << std::endl;
@@ -862,32 +917,11 @@ void CircularGenome<T>::deserialize(std::shared_ptr<ParametersTable> PT, std::un
 	}
 	int genomeLength;
 	convertString(orgData["GENOME_" + name + "_genomeLength"], genomeLength);
-
-	std::string allSites = orgData["GENOME_" + name + "_sites"];
-	std::stringstream ss(allSites);
-
-  bool streamNotEmpty(true);
-	sites.clear();
-  streamNotEmpty = static_cast<bool>(ss >> nextChar);
-	for (int i = 0; i < genomeLength; i++) {
-		nextString = "";
-		while (streamNotEmpty && (nextChar != ',')) {
-			nextString += nextChar;
-      streamNotEmpty = static_cast<bool>(ss >> nextChar);
-		}
-		convertString(nextString, value);
-		//std::cout << nextString << " = " << value << ", ";
-		sites.push_back(value);
-    streamNotEmpty = static_cast<bool>(ss >> nextChar);
-	}
-	//std::cout << std::endl;
+	parseSites(orgData["GENOME_" + name + "_sites"], genomeLength, sites);
 }
 
 template<>
 void CircularGenome<unsigned char>::deserialize(std::shared_ptr<ParametersTable> PT, std::unordered_map<std::string, std::string>& orgData, std::string& name) {
-	char nextChar;
-	std::string nextString;
-	int value;
 	// make sure that data has needed columns
 	if (orgData.find("GENOME_" + name + "_sites") == orgData.end() || orgData.find("GENOME_" + name + "_genomeLength") == orgData.end()) {
 		std::cout << "  In CircularGenome<T>::deserialize :: can not find either GENOME_" + name + "_sites or GENOME_" + name + "_genomeLength.\n  exiting" << std::endl;
@@ -895,25 +929,10 @@ void CircularGenome<unsigned char>::deserialize(std::shared_ptr<ParametersTable>
 	}
 	int genomeLength;
 	convertString(orgData["GENOME_" + name + "_genomeLength"], genomeLength);
-
-	std::string allSites = orgData["GENOME_" + name + "_sites"];
-	std::stringstream ss(allSites);
-
-	sites.clear();
-  bool streamNotEmpty(true);
-  streamNotEmpty = static_cast<bool>(ss >> nextChar);
-	for (int i = 0; i < genomeLength; i++) {
-		nextString = "";
-		while (streamNotEmpty && (nextChar != ',')) {
-			nextString += nextChar;
-            streamNotEmpty = static_cast<bool>(ss >> nextChar);
-		}
-		convertString(nextString, value);
-        //std::cout << nextString << " = " << value << ", ";
-		sites.push_back((unsigned char)value);
-		ss >> nextChar;
-	}
-  //std::cout << std::endl;
+	// unsigned char sites are written as ints
+	std::vector<int> values;
+	parseSites(orgData["GENOME_" + name + "_sites"], genomeLength, values);
+	sites.assign(values.begin(), values.end());
 }
 
 
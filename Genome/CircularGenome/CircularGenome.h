@@ -17,10 +17,14 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <type_traits>
 #include <utility>
 
 #include "../../Utilities/Utilities.h"
 #include "../../Utilities/Data.h"
+#include "../../Utilities/ObjectPool.h"
+#include "../../Utilities/PackedBits.h"
+#include "../../Utilities/ParameterBindings.h"
 #include "../../Utilities/Parameters.h"
 #include "../../Utilities/Random.h"
 #include "../AbstractGenome.h"
@@ -50,6 +54,32 @@ public:
 
 };
 
+// CircularGenome parameters for one ParametersTable, read once and shared
+// by every genome made with that table (see Utilities/ParameterBindings.h)
+class CircularGenomeSettings {
+public:
+	ParameterBindings bindings;
+	double mutationPointRate;
+	double mutationPointOffsetRate;
+	double mutationPointOffsetRange;
+	double mutationCopyRate;
+	int mutationCopyMinSize;
+	int mutationCopyMaxSize;
+	double mutationDeleteRate;
+	int mutationDeleteMinSize;
+	int mutationDeleteMaxSize;
+	int sizeMax;
+	int sizeMin;
+	int mutationCrossCount;
+	double mutationIndelRate;
+	int mutationIndelMinSize;
+	int mutationIndelMaxSize;
+	int mutationIndelInsertMethod;
+	bool mutationIndelCopyFirst;
+
+	CircularGenomeSettings(std::shared_ptr<ParametersTable> PT_);
+};
+
 template<class T>
 class CircularGenome : public AbstractGenome {
 
@@ -110,6 +140,7 @@ public:
 
 	std::vector<T> sites;
 	double alphabetSize;
+	std::shared_ptr<const CircularGenomeSettings> settings;
 
 	CircularGenome() = delete;
 
@@ -176,6 +207,21 @@ public:
 	virtual int incrementDelete();
 	virtual int incrementIndel();
 
+	// the mutation counters are carried over checkpoints
+	virtual void saveCheckpoint(Checkpoint::Writer& checkpoint) override {
+		checkpoint.put(std::vector<int>{ countPoint, countPointOffset, countDelete, countCopy, countIndel });
+	}
+	virtual void loadCheckpoint(Checkpoint::Reader& checkpoint) override {
+		std::vector<int> counts;
+		checkpoint.get(counts);
+		counts.resize(5);
+		countPoint = counts[0];
+		countPointOffset = counts[1];
+		countDelete = counts[2];
+		countCopy = counts[3];
+		countIndel = counts[4];
+	}
+
 	// apply mutations to this genome
 	virtual void mutate() override;
 
@@ -192,6 +238,26 @@ public:
 	// in this case, each parent crosses all of its chromosomes and contributs the result as a new chromosome
 	virtual std::shared_ptr<AbstractGenome> makeMutatedGenomeFromMany(std::vector<std::shared_ptr<AbstractGenome>> parents) override;
 
+	// genomes of this type that are no longer used, kept so the two functions
+	// above can reuse them (see Utilities/ObjectPool.h)
+	static ObjectPool<CircularGenome<T>>& pool() {
+		return ObjectPool<CircularGenome<T>>::instance(
+			std::is_same<T, bool>::value ? "circularGenome_bool" :
+			std::is_same<T, int>::value ? "circularGenome_int" :
+			std::is_same<T, double>::value ? "circularGenome_double" : "circularGenome_char");
+	}
+	// a genome with this genomes PT from pool(), or nullptr if there is none.
+	// It is empty, with all mutation counts 0.
+	std::shared_ptr<CircularGenome<T>> getPooled() {
+		return pool().get([this](const CircularGenome<T>& genome) { return genome.PT == PT; });
+	}
+	// called by pool() when a genome is no longer used (keeps the storage of sites)
+	void recycle() {
+		sites.clear();
+		countPoint = countPointOffset = countDelete = countCopy = countIndel = 0;
+		dataMap.clearMap();
+	}
+
 // IO and Data Management functions
 
 // gets data about genome which can be added to a data map
@@ -216,6 +282,28 @@ public:
 
 // Translation functions - convert genomes into usefull stuff
 
+	virtual bool getSiteValues(std::vector<uint32_t>& values) override {
+		if (std::is_floating_point<T>::value) {
+			return false;
+		}
+		values.resize(sites.size());
+		for (size_t i = 0; i < sites.size(); i++) {
+			values[i] = (uint32_t)sites[i];
+		}
+		return true;
+	}
+
+	virtual bool setSiteValues(const std::vector<uint32_t>& values) override {
+		if (std::is_floating_point<T>::value) {
+			return false;
+		}
+		sites.resize(values.size());
+		for (size_t i = 0; i < values.size(); i++) {
+			sites[i] = (T)values[i];
+		}
+		return true;
+	}
+
 	// convert a genome to a string
 	virtual std::string genomeToStr() override;
 
@@ -223,6 +311,18 @@ public:
     
 	std::shared_ptr<AbstractGenome> makeOneBitMutant(int idx);
 
+	// pack count sites into words, one bit per site (set if the site is nonzero),
+	// wrapping around to the start of the genome like a Handler does
+	void packSites(std::vector<uint64_t>& words, int count) {
+		words.assign(PackedBits::wordCount(count), 0);
+		int numSites = (int)sites.size();
+		for (int i = 0; i < count; i++) {
+			if (sites[i % numSites]) {
+				PackedBits::setBit(words.data(), i, true);
+			}
+		}
+	}
+
 
 };
 
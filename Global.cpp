@@ -29,6 +29,23 @@ std::shared_ptr<ParameterLink<std::string>> Global::modePL =
     Parameters::register_parameter(
         "GLOBAL-mode", std::string("run"),
         "mode to run MABE in [run,visualize,analyze]");
+std::shared_ptr<ParameterLink<int>> Global::checkpointIntervalPL =
+    Parameters::register_parameter(
+        "GLOBAL-checkpointInterval", 0,
+        "write the state of the run to checkpointFile every this many updates "
+        "(and when stopped with ctrl-c), so it can be resumed with resumeFrom. "
+        "0 = never");
+std::shared_ptr<ParameterLink<std::string>> Global::checkpointFilePL =
+    Parameters::register_parameter(
+        "GLOBAL-checkpointFile", std::string("checkpoint.bin"),
+        "name of the checkpoint file (written in outputPrefix, replacing the "
+        "last checkpoint)");
+std::shared_ptr<ParameterLink<std::string>> Global::resumeFromPL =
+    Parameters::register_parameter(
+        "GLOBAL-resumeFrom", std::string(""),
+        "checkpoint file to resume a run from instead of loading initPop. The "
+        "run must use the same settings and outputPrefix, and the Default "
+        "archivist. \"\" = start a new run");
 
 std::shared_ptr<ParameterLink<int>> Global::maxLineLengthPL =
     Parameters::register_parameter("PARAMETER_FILES-maxLineLength", 160,
@@ -41,6 +58,24 @@ std::shared_ptr<ParameterLink<std::string>> Global::outputPrefixPL =
     Parameters::register_parameter(
         "GLOBAL-outputPrefix", std::string("./"),
         "Directory and prefix specifying where data files will be written");
+std::shared_ptr<ParameterLink<int>> Global::outputBufferSizePL =
+    Parameters::register_parameter(
+        "GLOBAL-outputBufferSize", 65536,
+        "bytes of output held for each data file before a background thread "
+        "writes them. Files are also written at the end of the run, at "
+        "checkpoints and on ctrl-c. 0 = write and flush every line at once");
+std::shared_ptr<ParameterLink<bool>> Global::poolObjectsPL =
+    Parameters::register_parameter(
+        "GLOBAL-poolObjects", true,
+        "keep organisms (and their genomes and brains) that are no longer used "
+        "and reuse them for new offspring, rather than freeing them and "
+        "allocating new ones");
+std::shared_ptr<ParameterLink<std::string>> Global::poolCountsFilePL =
+    Parameters::register_parameter(
+        "GLOBAL-poolCountsFile", std::string(""),
+        "data file that gets, each update, how many organisms, genomes and "
+        "brains were newly made, how many were reused and how many are kept "
+        "for reuse. \"\" = do not write");
 
 // shared_ptr<ParameterLink<string>> Global::groupNameSpacesPL =
 // Parameters::register_parameter("GLOBAL-groups", (string) "[]", "name spaces
@@ -34,6 +34,13 @@ public:
   static std::shared_ptr<ParameterLink<std::string>>
       modePL; // run, visulaize, etc
 
+  static std::shared_ptr<ParameterLink<int>>
+      checkpointIntervalPL; // how often to write a checkpoint
+  static std::shared_ptr<ParameterLink<std::string>>
+      checkpointFilePL; // where checkpoints are written
+  static std::shared_ptr<ParameterLink<std::string>>
+      resumeFromPL; // checkpoint to resume from
+
   static std::shared_ptr<ParameterLink<int>>
       maxLineLengthPL; // max length of lines in the parameters files
   static std::shared_ptr<ParameterLink<int>>
@@ -41,6 +48,12 @@ public:
 
   static std::shared_ptr<ParameterLink<std::string>>
       outputPrefixPL; // where files will be written
+  static std::shared_ptr<ParameterLink<int>>
+      outputBufferSizePL; // bytes buffered per data file
+  static std::shared_ptr<ParameterLink<bool>>
+      poolObjectsPL; // reuse dead organisms, genomes and brains
+  static std::shared_ptr<ParameterLink<std::string>>
+      poolCountsFilePL; // where pool counts are written each update
 
   // static shared_ptr<ParameterLink<string>> groupNameSpacesPL;
 
@@ -23,7 +23,13 @@ Group::Group(std::vector<std::shared_ptr<Organism>> _population,
 
 Group::~Group() {}
 
-bool Group::archive(int flush) { return archivist->archive(population, flush); }
+bool Group::archive(int flush) {
+  bool finished = archivist->archive(population, flush);
+  if (flush) {
+    FileManager::flush(); // make sure everything archived is on disk
+  }
+  return finished;
+}
 
 void Group::optimize() { optimizer->optimize(population); }
 
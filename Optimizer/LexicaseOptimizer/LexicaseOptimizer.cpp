@@ -66,6 +66,7 @@ LexicaseOptimizer::LexicaseOptimizer(std::shared_ptr<ParametersTable> PT_)
 
 	for (auto s : optimizeFormulasStrings) {
 		optimizeFormulasMTs.push_back(stringToMTree(s));
+		compiledFormulas.emplace_back(optimizeFormulasMTs.back());
 	}
 
 	// get names to use with scores
@@ -192,13 +193,10 @@ void LexicaseOptimizer::optimize(
   scoresHaveDelta = false;
 
   scores.clear();
-  for (auto &opt_formula : optimizeFormulasMTs) {
+  for (auto &opt_formula : compiledFormulas) {
 
     std::vector<double> pop_scores;
-    pop_scores.reserve(population.size());
-
-    for (auto &org : population)
-      pop_scores.push_back(opt_formula->eval(org->dataMap, PT)[0]);
+    opt_formula.evalAll(population, PT, pop_scores);
 
     scores.push_back(pop_scores);
 
@@ -46,6 +46,7 @@ public:
 	bool recordOptimizeValues;
 
 	std::vector<std::shared_ptr<Abstract_MTree>> optimizeFormulasMTs;
+	std::vector<CompiledMTree> compiledFormulas; // optimizeFormulasMTs, compiled
 
 	LexicaseOptimizer(std::shared_ptr<ParametersTable> PT_ = nullptr);
 
@@ -67,6 +67,13 @@ Parameters::register_parameter("OPTIMIZER_SIMPLE-cullByRange", false,
 	"\nif false, cull will be relative to organism ranks"
 	"\n  i.e. find score of cullBelow*populaiton size best, and discard all orgs with lower score.");
 
+std::shared_ptr<ParameterLink<int>> SimpleOptimizer::threadsPL =
+Parameters::register_parameter("OPTIMIZER_SIMPLE-threads", 1,
+	"number of threads used to select parents and build offspring. 1 = serial, as MABE always has (earlier "
+	"seeds reproduce). Any other value picks parents and builds offspring in blocks, each with its own random "
+	"stream, so results do not depend on the number of threads (but differ from 1). 0 = one thread per "
+	"hardware thread");
+
 SimpleOptimizer::SimpleOptimizer(std::shared_ptr<ParametersTable> PT_)
 	: AbstractOptimizer(PT_) {
 
@@ -80,6 +87,10 @@ SimpleOptimizer::SimpleOptimizer(std::shared_ptr<ParametersTable> PT_)
 	elitismRangeMT = stringToMTree(elitismRangePL->get(PT));
 	nextPopSizeMT = stringToMTree(nextPopSizePL->get(PT));
 
+	compiledOptimizeValue = CompiledMTree(optimizeValueMT);
+	compiledSurviveRate = CompiledMTree(surviveRateMT);
+	compiledSelfRate = CompiledMTree(selfRateMT);
+
 	cullBelow = cullBelowPL->get(PT); // -1 or [0,1] orgs who ((opVal - min) / (max - min)) < cullBelow are culled before selection
 									  // culled orgs will not be automatically not be allowed to survive
 									  // if -1 (default) then cullBelowScore = 0
@@ -100,6 +111,9 @@ SimpleOptimizer::SimpleOptimizer(std::shared_ptr<ParametersTable> PT_)
 
 	cullByRange = cullByRangePL->get(PT);;
 
+	pool = std::make_shared<ThreadPool>(threadsPL->get(PT));
+	parallel = threadsPL->get(PT) != 1;
+
 	optimizeFormula = optimizeValueMT;
 
 	std::vector<std::string> selectorArgs;
@@ -131,6 +145,18 @@ SimpleOptimizer::SimpleOptimizer(std::shared_ptr<ParametersTable> PT_)
 	popFileColumns.push_back("optimizeValue");
 }
 
+void SimpleOptimizer::AbstractSelector::selectMany(int count, uint32_t seed, std::vector<int> &picks, ThreadPool &pool) {
+	const int blockSize = 1024;
+	picks.resize(count);
+	pool.parallelFor((count + blockSize - 1) / blockSize, [&](long long block, int) {
+		auto gen = Random::getStream(seed, block);
+		int end = std::min(count, (int)(block + 1) * blockSize);
+		for (int i = (int)block * blockSize; i < end; i++) {
+			picks[i] = select(gen);
+		}
+	});
+}
+
 void SimpleOptimizer::optimize(std::vector<std::shared_ptr<Organism>> &population) {
 	oldPopulationSize = static_cast<int>(population.size());
 
@@ -147,7 +173,7 @@ void SimpleOptimizer::optimize(std::vector<std::shared_ptr<Organism>> &populatio
 	surviveCount = 0;
 
 	aveScore = 0;
-	maxScore = optimizeValueMT->eval(population[0]->dataMap, PT)[0];
+	maxScore = compiledOptimizeValue.eval(population[0]->dataMap, PT);
 	minScore = maxScore;
 	auto scoresHaveDelta = false;
 
@@ -164,11 +190,12 @@ void SimpleOptimizer::optimize(std::vector<std::shared_ptr<Organism>> &populatio
 
 	// get all scores
 
+	compiledOptimizeValue.evalAll(population, PT, scores);
+	auto const optimizeValueKey = DataMap::keyOf("optimizeValue");
 	for (size_t i = 0; i < population.size(); i++) {
-		double opVal = optimizeValueMT->eval(population[i]->dataMap, PT)[0];
-		scores.push_back(opVal);
+		double opVal = scores[i];
 		aveScore += opVal;
-		population[i]->dataMap.set("optimizeValue", opVal);
+		population[i]->dataMap.set(optimizeValueKey, opVal);
 		//std::cout << population[i]->ID << " " << opVal << std::endl;
 		if (opVal > maxScore) {
 			maxScore = opVal;
@@ -248,9 +275,16 @@ void SimpleOptimizer::optimize(std::vector<std::shared_ptr<Organism>> &populatio
 		culledMaxScore = maxScore;
 	}
 
-	// figure out if an orgs survive
+	// figure out if an orgs survive (if the formula draws random numbers it
+	// must be evaluated in step with Random::P, so one organism at a time)
+	if (compiledSurviveRate.isCompiled()) {
+		compiledSurviveRate.evalAll(populationAfterCull, PT, surviveRates);
+	}
 	for (int i = 0; i < culledPopulationSize; i++) {
-		if (Random::P(surviveRateMT->eval(populationAfterCull[i]->dataMap, PT)[0])) {
+		double surviveRate = compiledSurviveRate.isCompiled()
+			? surviveRates[i]
+			: compiledSurviveRate.eval(populationAfterCull[i]->dataMap, PT);
+		if (Random::P(surviveRate)) {
 			surviveCount++;
 			nextPopulationSize++;
 		}
@@ -298,7 +332,7 @@ void SimpleOptimizer::optimize(std::vector<std::shared_ptr<Organism>> &populatio
 			for (auto brain : eliteParent->brains) {
 				newBrains[brain.first] = brain.second->makeCopy(brain.second->PT);
 			}
-			population.push_back(std::make_shared<Organism>(eliteParent, newGenomes, newBrains, eliteParent->PT));
+			population.push_back(Organism::make(eliteParent, newGenomes, newBrains, eliteParent->PT));
 			//std::cout << "added elite org: " << population.back()->ID << " from parent: " << eliteParent->ID << std::endl;
 			nextPopulationSize++;
 			eliteCount++;
@@ -307,29 +341,85 @@ void SimpleOptimizer::optimize(std::vector<std::shared_ptr<Organism>> &populatio
 		currentElite++;
 	}
 
-	// now select parents for remainder of population
-	std::vector<std::shared_ptr<Organism>> parents;
-	while (nextPopulationSize < nextPopulationTargetSize) { // while we have not
-															// filled up the next
-															// generation
-		if (numberParents == 1) {
-			auto parent = populationAfterCull[selector->select()]; // select from culled
-			population.push_back(parent->makeMutatedOffspringFrom(parent)); // add to population
-		}
-		else {
-			parents.clear();
-			parents.push_back(populationAfterCull[selector->select()]); // select from culled
-			if (Random::P(selfRateMT->eval(parents[0]->dataMap, PT)[0])) {
-				population.push_back(parents[0]->makeMutatedOffspringFrom(parents[0])); // push to population
+	if (!parallel) {
+		// now select parents for remainder of population
+		std::vector<std::shared_ptr<Organism>> parents;
+		while (nextPopulationSize < nextPopulationTargetSize) { // while we have not
+																// filled up the next
+																// generation
+			if (numberParents == 1) {
+				auto parent = populationAfterCull[selector->select()]; // select from culled
+				population.push_back(parent->makeMutatedOffspringFrom(parent)); // add to population
 			}
 			else {
+				parents.clear();
+				parents.push_back(populationAfterCull[selector->select()]); // select from culled
+				if (Random::P(compiledSelfRate.eval(parents[0]->dataMap, PT))) {
+					population.push_back(parents[0]->makeMutatedOffspringFrom(parents[0])); // push to population
+				}
+				else {
+					while (static_cast<int>(parents.size()) < numberParents) {
+						parents.push_back(populationAfterCull[selector->select()]); // select from culled
+					}
+					population.push_back(parents[0]->makeMutatedOffspringFromMany(parents)); // push to population
+				}
+			}
+			nextPopulationSize++;
+		}
+	}
+	else {
+		// now make offspring for the remainder of population. numberParents
+		// parents are picked (from culled) for every offspring up front, using
+		// their own random streams; if an offspring selfs, only its first parent
+		// is used.
+		int offspringCount = std::max(nextPopulationTargetSize - nextPopulationSize, 0);
+		selector->prepare();
+		selector->selectMany(offspringCount * numberParents, (uint32_t)Random::getCommonGenerator()(), picks, *pool);
+		std::vector<std::vector<std::shared_ptr<Organism>>> offspringParents(offspringCount);
+		for (int offspring = 0; offspring < offspringCount; offspring++) {
+			const int *pick = &picks[offspring * numberParents];
+			auto &parents = offspringParents[offspring];
+			parents.push_back(populationAfterCull[pick[0]]);
+			if (numberParents > 1 && !Random::P(compiledSelfRate.eval(parents[0]->dataMap, PT))) {
 				while (static_cast<int>(parents.size()) < numberParents) {
-					parents.push_back(populationAfterCull[selector->select()]); // select from culled
+					parents.push_back(populationAfterCull[pick[parents.size()]]);
 				}
-				population.push_back(parents[0]->makeMutatedOffspringFromMany(parents)); // push to population
 			}
 		}
-		nextPopulationSize++;
+
+		// the offspring's genomes and brains are built in blocks, each block
+		// drawing its mutations from its own random stream, so they do not
+		// depend on how many threads are used
+		const int blockSize = 64;
+		std::vector<std::unordered_map<std::string, std::shared_ptr<AbstractGenome>>> newGenomes(offspringCount);
+		std::vector<std::unordered_map<std::string, std::shared_ptr<AbstractBrain>>> newBrains(offspringCount);
+		auto seed = (uint32_t)Random::getCommonGenerator()();
+		pool->parallelFor((offspringCount + blockSize - 1) / blockSize, [&](long long block, int) {
+			auto gen = Random::getStream(seed, block);
+			Random::GeneratorScope scope(gen);
+			int end = std::min(offspringCount, (int)(block + 1) * blockSize);
+			for (int i = (int)block * blockSize; i < end; i++) {
+				auto &parents = offspringParents[i];
+				if (parents.size() == 1) {
+					parents[0]->makeMutatedContentsFrom(parents[0], newGenomes[i], newBrains[i]);
+				}
+				else {
+					parents[0]->makeMutatedContentsFromMany(parents, newGenomes[i], newBrains[i]);
+				}
+			}
+		});
+
+		// add the offspring to population (in order, so IDs do not depend on threads)
+		for (int i = 0; i < offspringCount; i++) {
+			auto &parents = offspringParents[i];
+			if (parents.size() == 1) {
+				population.push_back(Organism::make(parents[0], newGenomes[i], newBrains[i], parents[0]->PT));
+			}
+			else {
+				population.push_back(Organism::make(parents, newGenomes[i], newBrains[i], parents[0]->PT));
+			}
+			nextPopulationSize++;
+		}
 	}
 	std::cout << "max = " << std::to_string(maxScore)
 		<< "   ave = " << std::to_string(aveScore);
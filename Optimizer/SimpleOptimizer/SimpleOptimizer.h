@@ -10,6 +10,7 @@
 
 #include "../AbstractOptimizer.h"
 #include "../../Utilities/MTree.h"
+#include "../../Utilities/ThreadPool.h"
 
 #include <iostream>
 #include <sstream>
@@ -41,6 +42,7 @@ public:
   static std::shared_ptr<ParameterLink<double>> cullBelowPL;
   static std::shared_ptr<ParameterLink<double>> cullRemapPL;
   static std::shared_ptr<ParameterLink<bool>> cullByRangePL;
+  static std::shared_ptr<ParameterLink<int>> threadsPL;
 
   std::string selectionMethod;
   int numberParents;
@@ -76,8 +78,20 @@ public:
     SimpleOptimizer *SO;
     AbstractSelector() = default;
     AbstractSelector(SimpleOptimizer *SO_) : SO(SO_){};
-    virtual int select() = 0;
+    // called once per generation, after scoresAfterCull is set
+    virtual void prepare() {}
+    // return the index (in populationAfterCull) of a parent, drawing random
+    // numbers from gen. Must be safe to call from several threads at once.
+    virtual int select(Random::Generator &gen) = 0;
+    // the serial pick (threads = 1), drawing from the common generator as
+    // MABE always has, so earlier runs reproduce
+    virtual int select() { return select(Random::getCommonGenerator()); }
     virtual std::string getType() = 0;
+
+    // fill picks with count parents. Picks are made in blocks, each with its
+    // own random stream of seed, so they do not depend on the size of pool.
+    void selectMany(int count, uint32_t seed, std::vector<int> &picks,
+                    ThreadPool &pool);
   };
 
   class RouletteSelector : public AbstractSelector {
@@ -101,21 +115,65 @@ public:
       }
     }
 
+    // build the alias table (Vose's method) so that each pick is O(1).
+    // Organisms are picked in proportion to their score (scores < 0 count as
+    // 0); if no score is > 0 every organism is equally likely.
+    virtual void prepare() override {
+      int n = SO->culledPopulationSize;
+      probability.assign(n, 1.0);
+      alias.resize(n);
+      for (int i = 0; i < n; i++) {
+        alias[i] = i;
+      }
+      double total = 0;
+      for (int i = 0; i < n; i++) {
+        total += std::max(SO->scoresAfterCull[i], 0.0);
+      }
+      if (!(total > 0)) {
+        return;
+      }
+      std::vector<double> scaled(n);
+      std::vector<int> small, large; // scaled < 1 and >= 1
+      for (int i = 0; i < n; i++) {
+        scaled[i] = std::max(SO->scoresAfterCull[i], 0.0) * n / total;
+        (scaled[i] < 1 ? small : large).push_back(i);
+      }
+      while (!small.empty() && !large.empty()) {
+        int less = small.back();
+        int more = large.back();
+        small.pop_back();
+        probability[less] = scaled[less];
+        alias[less] = more;
+        scaled[more] = (scaled[more] + scaled[less]) - 1;
+        if (scaled[more] < 1) {
+          large.pop_back();
+          small.push_back(more);
+        }
+      }
+      // anything left over (only rounding error) keeps probability 1
+    }
+
+    virtual int select(Random::Generator &gen) override {
+      int pick = Random::getIndex(SO->culledPopulationSize, gen);
+      return (Random::getDouble(1, gen) < probability[pick]) ? pick
+                                                             : alias[pick];
+    }
+
+    // keep choosing a random organism until one is good enough
     virtual int select() override {
       int pick;
-	  //std::cout << SO->culledMaxScore << std::endl;
       do {
-        pick = Random::getIndex(SO->culledPopulationSize); // keep choosing a
-                                                        // random genome from
-                                                        // population until we
-                                                        // get one that's good
-                                                        // enough
-		//std::cout << "  " << pick << " score() " << SO->scoresAfterCull[pick] << std::endl;
-	  } while (Random::getDouble(1) > (SO->scoresAfterCull[pick] / SO->culledMaxScore));
+        pick = Random::getIndex(SO->culledPopulationSize);
+      } while (Random::getDouble(1) >
+               (SO->scoresAfterCull[pick] / SO->culledMaxScore));
       return pick;
     }
 
     virtual std::string getType() override { return (std::string) "Roulette"; }
+
+  private:
+    std::vector<double> probability; // keep pick, else take alias[pick]
+    std::vector<int> alias;
   };
 
   class TournamentSelector : public AbstractSelector {
@@ -165,11 +223,11 @@ public:
       }
     }
 
-    virtual int select() override {
+    virtual int select(Random::Generator &gen) override {
       int winner, challanger;
-      winner = Random::getIndex(SO->culledPopulationSize);
+      winner = Random::getIndex(SO->culledPopulationSize, gen);
       for (int i = 0; i < tournamentSize - 1; i++) {
-        challanger = Random::getIndex(SO->culledPopulationSize);
+        challanger = Random::getIndex(SO->culledPopulationSize, gen);
 		//std::cout << tournamentSize << " " << i << "  " <<
          //challanger<<"("<<SO->scoresAfterCull[challanger] << "),winner(" <<
          //SO->scoresAfterCull[winner] << ")";
@@ -188,9 +246,15 @@ public:
   };
 
   std::shared_ptr<AbstractSelector> selector;
+  std::vector<int> picks; // parents chosen for this generation
+  std::shared_ptr<ThreadPool> pool;
+  bool parallel; // threads != 1: parents and offspring are made in blocks
 
   std::shared_ptr<Abstract_MTree> optimizeValueMT, surviveRateMT, selfRateMT,
       elitismCountMT, elitismRangeMT, nextPopSizeMT;
+  // the per organism formulas, compiled (see CompiledMTree)
+  CompiledMTree compiledOptimizeValue, compiledSurviveRate, compiledSelfRate;
+  std::vector<double> surviveRates;
 
   SimpleOptimizer(std::shared_ptr<ParametersTable> PT_ = nullptr);
 
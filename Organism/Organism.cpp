@@ -62,21 +62,7 @@ Organism::Organism(
     std::shared_ptr<ParametersTable> PT_) {
   initOrganism(std::move(PT_));
 
-  genomes = _genomes;
-
-  for (auto genome : genomes) { // collect stats from genomes
-    std::string prefix;
-    (genome.first == "root::") ? prefix = "" : prefix = genome.first;
-    dataMap.merge(genome.second->getStats(prefix));
-  }
-
-  brains = _brains;
-
-  for (auto brain : _brains) { // collect stats from brains
-    std::string prefix;
-    (brain.first == "root::") ? prefix = "" : prefix = brain.first;
-    dataMap.merge(brain.second->getStats(prefix));
-  }
+  setContents(_genomes, _brains);
 
   ancestors.insert(ID); // it is it's own Ancestor for data tracking purposes
   snapshotAncestors.insert(ID);
@@ -95,32 +81,9 @@ Organism::Organism(
     std::shared_ptr<ParametersTable> PT_) {
   initOrganism(std::move(PT_));
 
-  genomes = _genomes;
-
-  for (auto genome : genomes) { // collect stats from genomes
-    std::string prefix;
-    (genome.first == "root::") ? prefix = "" : prefix = genome.first;
-    dataMap.merge(genome.second->getStats(prefix));
-  }
-
-  brains = _brains;
+  setContents(_genomes, _brains);
 
-  for (auto brain : _brains) { // collect stats from brains
-    std::string prefix;
-    (brain.first == "root::") ? prefix = "" : prefix = brain.first;
-    dataMap.merge(brain.second->getStats(prefix));
-  }
-
-  parents.push_back(from);
-  from->offspringCount++; // this parent has an(other) offspring
-  for (auto ancestorID : from->ancestors) {
-    ancestors.insert(ancestorID); // union all parents ancestors into this
-                                  // organisms ancestor set.
-  }
-  for (auto ancestorID : from->snapshotAncestors) {
-    snapshotAncestors.insert(ancestorID); // union all parents ancestors into
-                                          // this organisms ancestor set.
-  }
+  addParent(from);
 }
 
 /*
@@ -136,6 +99,16 @@ Organism::Organism(
     std::shared_ptr<ParametersTable> PT_) {
   initOrganism(std::move(PT_));
 
+  setContents(_genomes, _brains);
+
+  for (auto const &parent : from) {
+    addParent(parent);
+  }
+}
+
+void Organism::setContents(
+    std::unordered_map<std::string, std::shared_ptr<AbstractGenome>> &_genomes,
+    std::unordered_map<std::string, std::shared_ptr<AbstractBrain>> &_brains) {
   genomes = _genomes;
 
   for (auto genome : genomes) { // collect stats from genomes
@@ -151,19 +124,51 @@ Organism::Organism(
     (brain.first == "root::") ? prefix = "" : prefix = brain.first;
     dataMap.merge(brain.second->getStats(prefix));
   }
+}
+
+void Organism::addParent(const std::shared_ptr<Organism> &parent) {
+  parents.push_back(parent); // add this parent to the parents set
+  parent->offspringCount++;  // this parent has an(other) offspring
+  for (auto ancestorID : parent->ancestors) {
+    ancestors.insert(ancestorID); // union all parents ancestors into this
+                                  // organisms ancestor set
+  }
+  for (auto ancestorID : parent->snapshotAncestors) {
+    snapshotAncestors.insert(ancestorID); // union all parents ancestors into
+                                          // this organisms ancestor set.
+  }
+}
 
+std::shared_ptr<Organism> Organism::make(
+    const std::shared_ptr<Organism> &from,
+    std::unordered_map<std::string, std::shared_ptr<AbstractGenome>> &_genomes,
+    std::unordered_map<std::string, std::shared_ptr<AbstractBrain>> &_brains,
+    std::shared_ptr<ParametersTable> PT_) {
+  auto org = pool().get([](const Organism &) { return true; });
+  if (org == nullptr) {
+    return pool().adopt(new Organism(from, _genomes, _brains, std::move(PT_)));
+  }
+  org->initOrganism(std::move(PT_));
+  org->setContents(_genomes, _brains);
+  org->addParent(from);
+  return org;
+}
+
+std::shared_ptr<Organism> Organism::make(
+    const std::vector<std::shared_ptr<Organism>> &from,
+    std::unordered_map<std::string, std::shared_ptr<AbstractGenome>> &_genomes,
+    std::unordered_map<std::string, std::shared_ptr<AbstractBrain>> &_brains,
+    std::shared_ptr<ParametersTable> PT_) {
+  auto org = pool().get([](const Organism &) { return true; });
+  if (org == nullptr) {
+    return pool().adopt(new Organism(from, _genomes, _brains, std::move(PT_)));
+  }
+  org->initOrganism(std::move(PT_));
+  org->setContents(_genomes, _brains);
   for (auto const &parent : from) {
-    parents.push_back(parent); // add this parent to the parents set
-    parent->offspringCount++;  // this parent has an(other) offspring
-    for (auto ancestorID : parent->ancestors) {
-      ancestors.insert(ancestorID); // union all parents ancestors into this
-                                    // organisms ancestor set
-    }
-    for (auto ancestorID : parent->snapshotAncestors) {
-      snapshotAncestors.insert(ancestorID); // union all parents ancestors into
-                                            // this organisms ancestor set.
-    }
+    org->addParent(parent);
   }
+  return org;
 }
 
 // this function provides a unique ID value for every org
@@ -179,6 +184,20 @@ Organism::~Organism() {
   parents.clear();
 }
 
+void Organism::recycle() {
+  for (auto const &parent : parents) {
+    parent->offspringCount--; // this parent has one less child in memory
+  }
+  parents.clear(); // may recycle the parents too
+  genomes.clear();
+  brains.clear();
+  ancestors.clear();
+  snapshotAncestors.clear();
+  snapShotDataMaps.clear();
+  dataMap.clearMap();
+  trackOrganism = false;
+}
+
 /*
  * called to kill an organism. Set alive to false
  */
@@ -197,6 +216,25 @@ Organism::makeMutatedOffspringFrom(std::shared_ptr<Organism> from) {
 
   std::unordered_map<std::string, std::shared_ptr<AbstractGenome>> newGenomes;
   std::unordered_map<std::string, std::shared_ptr<AbstractBrain>> newBrains;
+  makeMutatedContentsFrom(from, newGenomes, newBrains);
+  return make(from, newGenomes, newBrains, PT);
+}
+
+std::shared_ptr<Organism> Organism::makeMutatedOffspringFromMany(
+    std::vector<std::shared_ptr<Organism>> from) {
+
+  std::unordered_map<std::string, std::shared_ptr<AbstractGenome>> newGenomes;
+  std::unordered_map<std::string, std::shared_ptr<AbstractBrain>> newBrains;
+  makeMutatedContentsFromMany(from, newGenomes, newBrains);
+  return make(from, newGenomes, newBrains, PT);
+}
+
+void Organism::makeMutatedContentsFrom(
+    const std::shared_ptr<Organism> &from,
+    std::unordered_map<std::string, std::shared_ptr<AbstractGenome>>
+        &newGenomes,
+    std::unordered_map<std::string, std::shared_ptr<AbstractBrain>>
+        &newBrains) {
 
   for (auto genome : from->genomes) {
     newGenomes[genome.first] =
@@ -208,15 +246,14 @@ Organism::makeMutatedOffspringFrom(std::shared_ptr<Organism> from) {
         brain.second->makeBrainFrom(brain.second, newGenomes);
     newBrains[brain.first]->mutate();
   }
-
-  return std::make_shared<Organism>(from, newGenomes, newBrains, PT);
 }
 
-std::shared_ptr<Organism> Organism::makeMutatedOffspringFromMany(
-    std::vector<std::shared_ptr<Organism>> from) {
-
-  std::unordered_map<std::string, std::shared_ptr<AbstractGenome>> newGenomes;
-  std::unordered_map<std::string, std::shared_ptr<AbstractBrain>> newBrains;
+void Organism::makeMutatedContentsFromMany(
+    const std::vector<std::shared_ptr<Organism>> &from,
+    std::unordered_map<std::string, std::shared_ptr<AbstractGenome>>
+        &newGenomes,
+    std::unordered_map<std::string, std::shared_ptr<AbstractBrain>>
+        &newBrains) {
 
   for (auto genome : from[0]->genomes) {
     std::vector<std::shared_ptr<AbstractGenome>>
@@ -239,8 +276,6 @@ std::shared_ptr<Organism> Organism::makeMutatedOffspringFromMany(
         brain.second->makeBrainFromMany(parentBrains, newGenomes);
     newBrains[brain.first]->mutate();
   }
-
-  return std::make_shared<Organism>(from, newGenomes, newBrains, PT);
 }
 
 /*
@@ -18,6 +18,7 @@
 #include "../Genome/AbstractGenome.h"
 
 #include "../Utilities/Data.h"
+#include "../Utilities/ObjectPool.h"
 #include "../Utilities/Parameters.h"
 
 class Organism {
@@ -25,6 +26,14 @@ private:
   static int organismIDCounter; // used to issue unique ids to Genomes
   int registerOrganism();       // get an Organism_id (uses organismIDCounter)
 
+  // install genomes and brains and collect their stats
+  void setContents(
+      std::unordered_map<std::string, std::shared_ptr<AbstractGenome>>
+          &_genomes,
+      std::unordered_map<std::string, std::shared_ptr<AbstractBrain>>
+          &_brains);
+  void addParent(const std::shared_ptr<Organism> &parent);
+
 public:
   DataMap dataMap; // holds all data (genome size, score, world data, etc.)
   std::map<int, DataMap> snapShotDataMaps; // Used only with SnapShot with Delay
@@ -62,6 +71,10 @@ public:
 
   void initOrganism(std::shared_ptr<ParametersTable> PT_);
 
+  // the next ID to be issued (saved and restored with checkpoints)
+  static int getIDCounter() { return organismIDCounter; }
+  static void setIDCounter(int next) { organismIDCounter = next; }
+
   Organism() = delete;
   Organism(
       std::shared_ptr<ParametersTable> PT_ = nullptr); // make an empty organism
@@ -95,6 +108,30 @@ public:
 
   virtual ~Organism();
 
+  // organisms that are no longer used, kept so make() can reuse them (see
+  // Utilities/ObjectPool.h)
+  static ObjectPool<Organism> &pool() {
+    return ObjectPool<Organism>::instance("organism");
+  }
+  // an organism from pool() (or a new one) set up as the constructor with
+  // the same arguments would
+  static std::shared_ptr<Organism>
+  make(const std::shared_ptr<Organism> &from,
+       std::unordered_map<std::string, std::shared_ptr<AbstractGenome>>
+           &_genomes,
+       std::unordered_map<std::string, std::shared_ptr<AbstractBrain>> &_brains,
+       std::shared_ptr<ParametersTable> PT_ = nullptr);
+  static std::shared_ptr<Organism>
+  make(const std::vector<std::shared_ptr<Organism>> &from,
+       std::unordered_map<std::string, std::shared_ptr<AbstractGenome>>
+           &_genomes,
+       std::unordered_map<std::string, std::shared_ptr<AbstractBrain>> &_brains,
+       std::shared_ptr<ParametersTable> PT_ = nullptr);
+  // called by pool() when an organism is no longer used. Lets go of its
+  // parents, genomes and brains (as the destructor would) and clears its
+  // data, keeping the storage.
+  void recycle();
+
   virtual void kill(); // sets alive = 0 (on org and in dataMap)
 
   virtual std::vector<std::shared_ptr<Organism>>
@@ -107,6 +144,21 @@ public:
   makeMutatedOffspringFrom(std::shared_ptr<Organism> parent);
   virtual std::shared_ptr<Organism>
   makeMutatedOffspringFromMany(std::vector<std::shared_ptr<Organism>> from);
+  // the genomes and brains the two functions above give a new offspring.
+  // These do not change any organism, so several offspring can be made at
+  // once on different threads (each with its own Random::GeneratorScope).
+  void makeMutatedContentsFrom(
+      const std::shared_ptr<Organism> &from,
+      std::unordered_map<std::string, std::shared_ptr<AbstractGenome>>
+          &newGenomes,
+      std::unordered_map<std::string, std::shared_ptr<AbstractBrain>>
+          &newBrains);
+  void makeMutatedContentsFromMany(
+      const std::vector<std::shared_ptr<Organism>> &from,
+      std::unordered_map<std::string, std::shared_ptr<AbstractGenome>>
+          &newGenomes,
+      std::unordered_map<std::string, std::shared_ptr<AbstractBrain>>
+          &newBrains);
   virtual std::shared_ptr<Organism>
   makeCopy(std::shared_ptr<ParametersTable> PT_ = nullptr);
 };
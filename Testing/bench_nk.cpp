@@ -0,0 +1,132 @@
+// Times the NK scoring kernels (World/NKWorld/NKKernels.h) specialized for
+// each K against the generic kernel, on random landscapes and genomes.
+// Build and run with "make bench".
+
+#include "../World/NKWorld/NKKernels.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace NKKernels;
+
+const int N = 200;
+const int numGenomes = 64 * 64;
+const int repeats = 20;
+const double scale = 1099511627776.0; // 2^40, table values are kept in fixed point
+
+// seconds per call of score, best of repeats
+template <typename F> double timePerCall(F score, int calls) {
+  double best = 1e30;
+  for (int r = 0; r < repeats; r++) {
+    auto start = std::chrono::steady_clock::now();
+    score();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count() / calls);
+  }
+  return best;
+}
+
+// ns per genome of each kernel, generic and specialized; exits if the scores
+// differ
+void bench(int K, const std::vector<int64_t> &localValues,
+           const std::vector<std::pair<int, int64_t>> &patterns) {
+  int words = PackedBits::wordCount(N + K - 1);
+  std::mt19937_64 rng(K);
+  std::vector<uint64_t> genomes((size_t)numGenomes * words);
+  for (int g = 0; g < numGenomes; g++) {
+    uint64_t *packed = &genomes[(size_t)g * words];
+    for (int w = 0; w < words; w++) packed[w] = rng();
+    for (int n = N; n < N + K - 1; n++) {
+      PackedBits::setBit(packed, n, PackedBits::getBit(packed, n % N));
+    }
+    for (size_t b = N + K - 1; b < (size_t)words * PackedBits::bitsPerWord; b++) {
+      PackedBits::setBit(packed, b, false);
+    }
+  }
+  // slices of every block of 64 genomes
+  std::vector<uint64_t> slices(genomes.size());
+  for (int block = 0; block < numGenomes / 64; block++) {
+    for (int w = 0; w < words; w++) {
+      uint64_t *slice = &slices[((size_t)block * words + w) * 64];
+      for (int j = 0; j < 64; j++) slice[j] = genomes[((size_t)block * 64 + j) * words + w];
+      PackedBits::transpose64(slice);
+    }
+  }
+  Landscape landscape = {N, K, localValues.data(), patterns.data(), patterns.size(), scale, 0};
+  Kernels generic = kernelsFor<0>();
+  Kernels specialized = select(K);
+  std::vector<double> expected(numGenomes), scores(numGenomes);
+  double sink = 0;
+
+  std::printf("%4d %6s %12s", K, patterns.empty() ? "random" : "flat",
+              specialized.K == 0 ? "generic" : "specialized");
+  const Kernels *sets[2] = {&generic, &specialized};
+  for (int s = 0; s < 2; s++) {
+    const Kernels &kernels = *sets[s];
+    double windows = timePerCall([&]() {
+      for (int g = 0; g < numGenomes; g++)
+        scores[g] = kernels.windows(landscape, &genomes[(size_t)g * words]);
+    }, numGenomes);
+    if (s == 0) expected = scores;
+    bool same = scores == expected;
+    double sliced = timePerCall([&]() {
+      for (int block = 0; block < numGenomes / 64; block++)
+        kernels.slices(landscape, &slices[(size_t)block * words * 64], 64, &scores[block * 64]);
+    }, numGenomes);
+    same = same && scores == expected;
+    double sparse = 0;
+    if (!patterns.empty()) {
+      sparse = timePerCall([&]() {
+        for (int g = 0; g < numGenomes; g++)
+          scores[g] = kernels.sparse(landscape, &genomes[(size_t)g * words]);
+      }, numGenomes);
+      same = same && scores == expected;
+    }
+    if (!same) {
+      std::printf("\nERROR! Kernels for K = %d give different scores!\n", K);
+      exit(1);
+    }
+    std::printf(" %10.1f %10.1f", windows * 1e9, sliced * 1e9);
+    if (patterns.empty())
+      std::printf(" %10s", "-");
+    else
+      std::printf(" %10.1f", sparse * 1e9);
+    sink += scores[0];
+  }
+  std::printf("\n");
+  if (sink < 0) std::printf("%f\n", sink);
+}
+
+int main() {
+  std::printf("N = %d, %d genomes, ns per genome (best of %d). Flat tables have the same\n"
+              "4 nonzero patterns on every row.\n\n", N, numGenomes, repeats);
+  std::printf("%4s %6s %12s %32s %32s\n", "", "", "", "---------- generic ----------",
+              "------ selected for K -------");
+  std::printf("%4s %6s %12s", "K", "table", "selected");
+  for (int s = 0; s < 2; s++) std::printf(" %10s %10s %10s", "windows", "sliced", "sparse");
+  std::printf("\n");
+  int Ks[] = {2, 3, 4, 5, 6, 8, 10};
+  for (int K : Ks) {
+    std::mt19937_64 rng(K);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<int64_t> localValues((size_t)N << K);
+    for (int64_t &value : localValues) value = toFixed(uniform(rng), scale);
+    bench(K, localValues, {});
+    // flat table: the same 4 patterns rewarded at every locus
+    std::vector<std::pair<int, int64_t>> patterns;
+    for (int val = 0; (int)patterns.size() < 4; val = (val * 5 + 3) % (1 << K)) {
+      if (std::find_if(patterns.begin(), patterns.end(), [val](const std::pair<int, int64_t> &p) {
+            return p.first == val;
+          }) == patterns.end())
+        patterns.push_back({val, toFixed(1.0 + patterns.size() * 0.5, scale)});
+    }
+    std::fill(localValues.begin(), localValues.end(), 0);
+    for (int n = 0; n < N; n++)
+      for (auto &pattern : patterns) localValues[((size_t)n << K) | pattern.first] = pattern.second;
+    bench(K, localValues, patterns);
+  }
+  return 0;
+}
@@ -0,0 +1,163 @@
+#include "../Utilities/EditDistance.h"
+
+#include <map>
+#include <random>
+
+using namespace EditDistanceKernels;
+
+// References: the full (n + 1) x (m + 1) tables, as in the textbooks
+namespace editDistanceReference {
+
+size_t levenshtein(const std::vector<size_t> &a, const std::vector<size_t> &b) {
+	std::vector<std::vector<size_t>> d(a.size() + 1, std::vector<size_t>(b.size() + 1));
+	for (size_t i = 0; i <= a.size(); i++) d[i][0] = i;
+	for (size_t j = 0; j <= b.size(); j++) d[0][j] = j;
+	for (size_t i = 1; i <= a.size(); i++) {
+		for (size_t j = 1; j <= b.size(); j++) {
+			d[i][j] = std::min({d[i - 1][j] + 1, d[i][j - 1] + 1,
+			                    d[i - 1][j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1)});
+		}
+	}
+	return d[a.size()][b.size()];
+}
+
+size_t lcs(const std::vector<size_t> &a, const std::vector<size_t> &b) {
+	std::vector<std::vector<size_t>> d(a.size() + 1, std::vector<size_t>(b.size() + 1, 0));
+	for (size_t i = 1; i <= a.size(); i++) {
+		for (size_t j = 1; j <= b.size(); j++) {
+			d[i][j] = a[i - 1] == b[j - 1] ? d[i - 1][j - 1] + 1
+			                               : std::max(d[i - 1][j], d[i][j - 1]);
+		}
+	}
+	return d[a.size()][b.size()];
+}
+
+// Damerau-Levenshtein with adjacent transpositions (Lowrance and Wagner),
+// the last row of each symbol kept in a map
+size_t damerauLevenshtein(const std::vector<size_t> &a, const std::vector<size_t> &b) {
+	size_t max_dist = a.size() + b.size();
+	std::vector<std::vector<size_t>> d(a.size() + 2, std::vector<size_t>(b.size() + 2));
+	d[0][0] = max_dist;
+	for (size_t i = 0; i <= a.size(); i++) {
+		d[i + 1][0] = max_dist;
+		d[i + 1][1] = i;
+	}
+	for (size_t j = 0; j <= b.size(); j++) {
+		d[0][j + 1] = max_dist;
+		d[1][j + 1] = j;
+	}
+	std::map<size_t, size_t> da;
+	for (size_t i = 1; i <= a.size(); i++) {
+		size_t db = 0;
+		for (size_t j = 1; j <= b.size(); j++) {
+			size_t k = da.count(b[j - 1]) ? da[b[j - 1]] : 0;
+			size_t l = db;
+			size_t cost = 1;
+			if (a[i - 1] == b[j - 1]) {
+				cost = 0;
+				db = j;
+			}
+			d[i + 1][j + 1] = std::min({d[i][j] + cost, d[i + 1][j] + 1, d[i][j + 1] + 1,
+			                            d[k][l] + (i - k - 1) + 1 + (j - l - 1)});
+		}
+		da[a[i - 1]] = i;
+	}
+	return d[a.size() + 1][b.size() + 1];
+}
+
+// count symbols drawn from [0, symbols)
+std::vector<size_t> randomVector(std::mt19937 &rng, size_t count, size_t symbols) {
+	std::vector<size_t> vec(count);
+	for (size_t &x : vec) x = rng() % symbols;
+	return vec;
+}
+
+// Pairs of every kind the kernels treat differently: empty, single words and
+// several words of bits, few and many symbols, rank vectors (permutations
+// without repeats) and sorted vectors with repeats and a permutation of them
+std::vector<std::pair<std::vector<size_t>, std::vector<size_t>>> pairs() {
+	std::mt19937 rng(2015);
+	std::vector<std::pair<std::vector<size_t>, std::vector<size_t>>> result;
+	result.push_back({{}, {}});
+	result.push_back({{}, {1, 2, 3}});
+	result.push_back({{4, 5}, {}});
+	size_t lengths[] = {1, 2, 7, 63, 64, 65, 130};
+	for (size_t n : lengths) {
+		for (int repeat = 0; repeat < 10; repeat++) {
+			result.push_back({randomVector(rng, n, 3), randomVector(rng, rng() % 140, 3)});
+			result.push_back({randomVector(rng, n, 40), randomVector(rng, n, 40)});
+			std::vector<size_t> ranks(n);
+			for (size_t i = 0; i < n; i++) ranks[i] = i;
+			std::vector<size_t> shuffled = ranks;
+			std::shuffle(shuffled.begin(), shuffled.end(), rng);
+			result.push_back({shuffled, ranks});
+			std::shuffle(ranks.begin(), ranks.end(), rng);
+			result.push_back({shuffled, ranks});
+			std::vector<size_t> sorted = randomVector(rng, n, 4);
+			std::sort(sorted.begin(), sorted.end());
+			shuffled = sorted;
+			std::shuffle(shuffled.begin(), shuffled.end(), rng);
+			result.push_back({sorted, shuffled});
+			result.push_back({shuffled, sorted});
+		}
+	}
+	return result;
+}
+
+} // namespace editDistanceReference
+
+TEST(levenshteinBits, MatchesFullTable) {
+	for (auto &p : editDistanceReference::pairs()) {
+		EXPECT_EQ(levenshteinBits(p.first, p.second), editDistanceReference::levenshtein(p.first, p.second))
+			<< "lengths " << p.first.size() << " and " << p.second.size();
+		EXPECT_EQ(levenshteinRows(p.first, p.second), editDistanceReference::levenshtein(p.first, p.second))
+			<< "lengths " << p.first.size() << " and " << p.second.size();
+	}
+}
+
+TEST(EditDistance_L, WikipediaExamples) {
+	EXPECT_EQ(EditDistance_L({'s', 'i', 't', 't', 'i', 'n', 'g'}, {'k', 'i', 't', 't', 'e', 'n'}), 3)
+		<< "kitten and sitting are 3 edits apart";
+	EXPECT_EQ(EditDistance_L({'s', 'u', 'n', 'd', 'a', 'y'}, {'s', 'a', 't', 'u', 'r', 'd', 'a', 'y'}), 3)
+		<< "sunday and saturday are 3 edits apart";
+}
+
+TEST(lcsBits, MatchesFullTable) {
+	for (auto &p : editDistanceReference::pairs()) {
+		EXPECT_EQ(lcsBits(p.first, p.second), editDistanceReference::lcs(p.first, p.second))
+			<< "lengths " << p.first.size() << " and " << p.second.size();
+	}
+}
+
+TEST(lcsPermutation, MatchesFullTableOrDeclines) {
+	int used = 0;
+	for (auto &p : editDistanceReference::pairs()) {
+		long long lcs = lcsPermutation(p.first, p.second);
+		if (lcs >= 0) {
+			used++;
+			EXPECT_EQ((size_t)lcs, editDistanceReference::lcs(p.first, p.second))
+				<< "lengths " << p.first.size() << " and " << p.second.size();
+		}
+	}
+	EXPECT_GT(used, 0) << "some pairs should be permutations of each other";
+	EXPECT_EQ(lcsPermutation({1, 2}, {1, 2, 3}), -1) << "vectors of different lengths are not permutations";
+	EXPECT_EQ(lcsPermutation({1, 2, 3}, {1, 2, 4}), -1) << "vectors with different symbols are not permutations";
+	EXPECT_EQ(lcsPermutation({2, 1, 2}, {2, 2, 1}), -1) << "repeats in an unsorted vector can match crosswise";
+}
+
+TEST(EditDistance_Indel, MatchesFullTable) {
+	for (auto &p : editDistanceReference::pairs()) {
+		EXPECT_EQ(EditDistance_Indel(p.first, p.second),
+		          p.first.size() + p.second.size() - 2 * editDistanceReference::lcs(p.first, p.second))
+			<< "lengths " << p.first.size() << " and " << p.second.size();
+	}
+}
+
+TEST(EditDistance_DL, MatchesFullTable) {
+	for (auto &p : editDistanceReference::pairs()) {
+		EXPECT_EQ(EditDistance_DL(p.first, p.second), editDistanceReference::damerauLevenshtein(p.first, p.second))
+			<< "lengths " << p.first.size() << " and " << p.second.size();
+	}
+	EXPECT_EQ(EditDistance_DL({'a', ' ', 'c', 'a', 't'}, {'a', ' ', 'a', 'b', 'c', 't'}), 2)
+		<< "a cat and a abct are 2 edits apart with transpositions";
+}
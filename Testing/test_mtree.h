@@ -0,0 +1,121 @@
+#include "../Utilities/MTree.h"
+
+// Trees for checking CompiledMTree against Abstract_MTree::eval
+namespace mtreeTest {
+
+typedef std::shared_ptr<Abstract_MTree> Tree;
+
+Tree c(double value) { return std::make_shared<CONST_MTree>(value); }
+Tree ave(const std::string &key) { return std::make_shared<fromDataMapAve_MTree>(key); }
+Tree sum(const std::string &key) { return std::make_shared<fromDataMapSum_MTree>(key); }
+
+template <class Node> Tree op(std::vector<Tree> branches) {
+	return std::make_shared<Node>(branches);
+}
+
+// DataMaps with different values of x (a list, so DM_AVE and DM_SUM differ)
+// and of y, including 0 and negative values
+std::vector<DataMap> dataMaps() {
+	double xs[][3] = {{0.25, 1.5, 2}, {-3, 0.5, 4}, {0, 0, 0}, {7, -7, 1}, {1, 1, 1}};
+	double ys[] = {0, 2.5, -1, 3, 0.75};
+	std::vector<DataMap> maps(5);
+	for (size_t i = 0; i < maps.size(); i++) {
+		for (double x : xs[i]) maps[i].append("x", x);
+		maps[i].set("y", ys[i]);
+	}
+	return maps;
+}
+
+// compiles tree, then checks eval and evalAll on every DataMap against the
+// tree itself
+void expectSame(Tree tree, bool compiles = true) {
+	CompiledMTree compiled(tree);
+	EXPECT_EQ(compiled.isCompiled(), compiles) << tree->getFormula();
+	auto maps = dataMaps();
+	std::vector<DataMap *> pointers;
+	for (auto &map : maps) pointers.push_back(&map);
+	std::vector<double> values;
+	compiled.evalAll(pointers, nullptr, values);
+	ASSERT_EQ(values.size(), maps.size());
+	for (size_t i = 0; i < maps.size(); i++) {
+		double expected = tree->eval(maps[i], nullptr)[0];
+		EXPECT_EQ(compiled.eval(maps[i], nullptr), expected) << tree->getFormula() << " on DataMap " << i;
+		EXPECT_EQ(values[i], expected) << tree->getFormula() << " on DataMap " << i << " (evalAll)";
+	}
+}
+
+} // namespace mtreeTest
+
+using namespace mtreeTest;
+
+TEST(CompiledMTree, Leaves) {
+	expectSame(c(3.5));
+	expectSame(ave("x"));
+	expectSame(sum("x"));
+	Global::update = 12;
+	expectSame(std::make_shared<UPDATE_MTree>());
+	Global::update = 0;
+}
+
+TEST(CompiledMTree, Arithmetic) {
+	expectSame(op<SUM_MTree>({ave("x"), sum("y"), c(-1.25)}));
+	expectSame(op<MULT_MTree>({ave("x"), ave("y"), c(3)}));
+	expectSame(op<SUBTRACT_MTree>({sum("x"), ave("y")}));
+	expectSame(op<DIVIDE_MTree>({sum("x"), ave("y")}));
+	expectSame(op<POW_MTree>({c(2), ave("y")}));
+	expectSame(op<POW_MTree>({ave("y"), c(3)}));
+}
+
+TEST(CompiledMTree, DivideByZeroIsZero) {
+	expectSame(op<DIVIDE_MTree>({c(5), c(0)}));
+	expectSame(op<DIVIDE_MTree>({ave("x"), op<SUBTRACT_MTree>({ave("y"), ave("y")})}));
+	EXPECT_EQ(CompiledMTree(op<DIVIDE_MTree>({c(5), c(0)})).eval(dataMaps()[0], nullptr), 0);
+}
+
+TEST(CompiledMTree, Mod) {
+	expectSame(op<MOD_MTree>({sum("x"), c(3)}));
+	expectSame(op<MOD_MTree>({c(-7), ave("y")}));
+	// an int divisor of 0 (here 0.5, truncated) is taken as 1
+	expectSame(op<MOD_MTree>({c(7), c(0.5)}));
+	expectSame(op<MOD_MTree>({sum("x"), c(0)}));
+	EXPECT_EQ(CompiledMTree(op<MOD_MTree>({c(7), c(0.5)})).eval(dataMaps()[0], nullptr), 0);
+}
+
+TEST(CompiledMTree, Functions) {
+	expectSame(op<SIN_MTree>({ave("x")}));
+	expectSame(op<COS_MTree>({sum("x")}));
+	expectSame(op<ABS_MTree>({ave("y")}));
+	expectSame(op<IF_MTree>({ave("y"), c(1), sum("x")}));
+	expectSame(op<MIN_MTree>({ave("x"), ave("y")}));
+	expectSame(op<MIN_MTree>({ave("x"), ave("y"), c(0.5)}));
+	expectSame(op<MAX_MTree>({ave("x"), ave("y")}));
+	expectSame(op<MAX_MTree>({ave("x"), ave("y"), c(0.5)}));
+	expectSame(op<MANY_MTree>({ave("y"), ave("x")}));
+}
+
+TEST(CompiledMTree, Remap) {
+	expectSame(op<REMAP_MTree>({ave("y")}));
+	expectSame(op<REMAP_MTree>({ave("x"), c(-1), c(3)}));
+	expectSame(op<REMAP_MTree>({ave("x"), c(-1), c(3), c(10), ave("y")}));
+}
+
+TEST(CompiledMTree, Sigmoid) {
+	expectSame(op<SIGMOID_MTree>({ave("y"), c(2)}));
+	expectSame(op<SIGMOID_MTree>({op<REMAP_MTree>({ave("x"), c(-4), c(4)}), c(0.5)}));
+	expectSame(op<SIGMOID_MTree>({ave("x"), c(3), c(-2), c(5)}));
+	expectSame(op<SIGMOID_MTree>({ave("y"), ave("y"), c(-1), c(4)}));
+}
+
+TEST(CompiledMTree, NestedFormula) {
+	expectSame(stringToMTree("(DM_AVE[x]*2)+(DM_SUM[y]/3)"));
+	expectSame(op<IF_MTree>({op<SUBTRACT_MTree>({ave("x"), c(1)}),
+	                         op<REMAP_MTree>({sum("x"), c(0), c(5), ave("y"), c(2)}),
+	                         op<MOD_MTree>({op<MULT_MTree>({sum("x"), c(10)}), c(4)})}));
+}
+
+TEST(CompiledMTree, RandomIsNotCompiled) {
+	CompiledMTree compiled(op<RANDOM_MTree>({c(0), c(1)}));
+	EXPECT_FALSE(compiled.isCompiled()) << "RANDOM draws numbers, so it is left to the tree";
+	CompiledMTree inside(op<SUM_MTree>({c(1), op<RANDOM_MTree>({c(0), c(1)})}));
+	EXPECT_FALSE(inside.isCompiled()) << "a tree containing RANDOM is left to the tree";
+}
@@ -2,6 +2,10 @@
 #include <iostream>
 
 #include "test_graycode.h"
+#include "test_editdistance.h"
+#include "test_mtree.h"
+
+#include "../Utilities/gitversion.h" // Parameters.cpp prints it
 
 int main(int argc, char* argv[]) {
 	testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,62 @@
+//  MABE is a product of The Hintze Lab @ MSU
+//     for general research information:
+//         hintzelab.msu.edu
+//     for MABE documentation:
+//         github.com/Hintzelab/MABE/wiki
+//
+//  Copyright (c) 2015 Michigan State University. All rights reserved.
+//     to view the full license, visit:
+//         github.com/Hintzelab/MABE/wiki/License
+
+// This file provides an allocator that starts every block on an Alignment
+// byte boundary (a cache line by default), for lookup tables that are read
+// in fixed size rows. Use it through AlignedVector<T>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+template <typename T, size_t Alignment = 64> class AlignedAllocator {
+public:
+  using value_type = T;
+
+  template <typename U> struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() = default;
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+  // over-allocate, round up to the boundary and keep the address new returned
+  // just in front of the block so deallocate can find it
+  T *allocate(size_t count) {
+    size_t bytes = count * sizeof(T) + Alignment + sizeof(void *);
+    char *raw = static_cast<char *>(::operator new(bytes));
+    uintptr_t start = reinterpret_cast<uintptr_t>(raw) + sizeof(void *);
+    uintptr_t aligned = (start + Alignment - 1) & ~(uintptr_t)(Alignment - 1);
+    reinterpret_cast<void **>(aligned)[-1] = raw;
+    return reinterpret_cast<T *>(aligned);
+  }
+
+  void deallocate(T *block, size_t) {
+    ::operator delete(reinterpret_cast<void **>(block)[-1]);
+  }
+};
+
+template <typename T, typename U, size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment> &,
+                const AlignedAllocator<U, Alignment> &) {
+  return true;
+}
+
+template <typename T, typename U, size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment> &,
+                const AlignedAllocator<U, Alignment> &) {
+  return false;
+}
+
+template <typename T> using AlignedVector = std::vector<T, AlignedAllocator<T>>;
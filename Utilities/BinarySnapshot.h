@@ -0,0 +1,258 @@
+//  MABE is a product of The Hintze Lab @ MSU
+//     for general research information:
+//         hintzelab.msu.edu
+//     for MABE documentation:
+//         github.com/Hintzelab/MABE/wiki
+//
+//  Copyright (c) 2015 Michigan State University. All rights reserved.
+//     to view the full license, visit:
+//         github.com/Hintzelab/MABE/wiki/License
+
+// This file provides a compact binary format for snapshot organisms files,
+// written by DefaultArchivist and read by both the Loader and the standalone
+// analysis tool (analysis/cpp_analysis). It only depends on the standard
+// library.
+//
+// A file is a header followed by one fixed-width record per organism:
+//   header: "MABESNAP", version (uint32), genome length N (uint64), alphabet
+//           size (uint32), bits per site (uint32), population size (uint64),
+//           genome name, column count (uint32), column names
+//           (names are a uint32 length followed by the characters)
+//   record: ID (int64), number of sites (uint32), N sites packed into
+//           bytes, one double per column
+// Site i of a genome occupies bits [i * bitsPerSite, (i + 1) * bitsPerSite)
+// counting from the least significant bit of byte 0, so a genome with an
+// alphabet of 2 is one bit per site in the same order as PackedBits. Genomes
+// shorter than N are padded with 0. Numbers are stored in the byte order of
+// the machine that wrote the file.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace BinarySnapshot {
+
+const char magic[8] = {'M', 'A', 'B', 'E', 'S', 'N', 'A', 'P'};
+const uint32_t version = 1;
+const uint32_t maxNameLength = 1 << 16; // guards against reading garbage
+
+struct Header {
+  uint64_t genomeLength = 0;   // N, the length of the longest genome
+  uint32_t alphabetSize = 2;   // sites hold values in [0, alphabetSize)
+  uint32_t bitsPerSite = 1;
+  uint64_t populationSize = 0; // number of records
+  std::string genomeName;      // e.g. "root::"
+  std::vector<std::string> columns; // numeric dataMap columns in each record
+
+  // bytes used by the genome of each record
+  size_t genomeBytes() const {
+    return (genomeLength * bitsPerSite + 7) / 8;
+  }
+  // bytes used by each record
+  size_t recordBytes() const {
+    return sizeof(int64_t) + sizeof(uint32_t) + genomeBytes() +
+           columns.size() * sizeof(double);
+  }
+};
+
+struct Record {
+  int64_t ID = 0;
+  uint32_t siteCount = 0;
+  std::vector<uint8_t> genome; // packed sites (see top of file)
+  std::vector<double> values;  // one per column
+
+  uint32_t site(size_t index, uint32_t bitsPerSite) const {
+    uint32_t value = 0;
+    size_t bit = index * bitsPerSite;
+    for (uint32_t b = 0; b < bitsPerSite; b++, bit++) {
+      value |= (uint32_t)((genome[bit / 8] >> (bit % 8)) & 1) << b;
+    }
+    return value;
+  }
+};
+
+// smallest number of bits that can hold every value below alphabetSize
+inline uint32_t bitsForAlphabet(uint32_t alphabetSize) {
+  uint32_t bits = 1;
+  while (bits < 32 && ((uint64_t)1 << bits) < alphabetSize) {
+    bits++;
+  }
+  return bits;
+}
+
+// true if the file starts with the binary snapshot magic
+inline bool isBinarySnapshot(const std::string &fileName) {
+  std::ifstream file(fileName, std::ios::binary);
+  char start[sizeof(magic)];
+  return file.read(start, sizeof(magic)) &&
+         std::memcmp(start, magic, sizeof(magic)) == 0;
+}
+
+class Writer {
+public:
+  // create fileName and write the header; header.populationSize records
+  // must follow. Returns false if the file can not be opened.
+  bool open(const std::string &fileName, const Header &header_) {
+    header = header_;
+    header.bitsPerSite = bitsForAlphabet(header.alphabetSize);
+    file.open(fileName, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+      return false;
+    }
+    file.write(magic, sizeof(magic));
+    put(version);
+    put(header.genomeLength);
+    put(header.alphabetSize);
+    put(header.bitsPerSite);
+    put(header.populationSize);
+    putString(header.genomeName);
+    put((uint32_t)header.columns.size());
+    for (auto const &column : header.columns) {
+      putString(column);
+    }
+    return (bool)file;
+  }
+
+  // append one record; sites must be below the alphabet size, and there must
+  // be no more sites than the genome length or values than columns
+  template <class Site>
+  void write(int64_t ID, const std::vector<Site> &sites,
+             const std::vector<double> &values) {
+    buffer.assign(header.recordBytes(), 0);
+    uint8_t *out = buffer.data();
+    std::memcpy(out, &ID, sizeof(ID));
+    out += sizeof(ID);
+    uint32_t siteCount = (uint32_t)sites.size();
+    std::memcpy(out, &siteCount, sizeof(siteCount));
+    out += sizeof(siteCount);
+    size_t bit = 0;
+    for (auto const &s : sites) {
+      uint32_t value = (uint32_t)s;
+      for (uint32_t b = 0; b < header.bitsPerSite; b++, bit++) {
+        out[bit / 8] |= (uint8_t)(((value >> b) & 1) << (bit % 8));
+      }
+    }
+    out += header.genomeBytes();
+    std::memcpy(out, values.data(), values.size() * sizeof(double));
+    file.write((const char *)buffer.data(), buffer.size());
+  }
+
+  // returns false if anything failed to write
+  bool close() {
+    file.close();
+    return !file.fail();
+  }
+
+private:
+  std::ofstream file;
+  Header header;
+  std::vector<uint8_t> buffer;
+
+  template <class Number> void put(Number value) {
+    file.write((const char *)&value, sizeof(value));
+  }
+  void putString(const std::string &s) {
+    put((uint32_t)s.size());
+    file.write(s.data(), s.size());
+  }
+};
+
+class Reader {
+public:
+  // open fileName and read its header. Returns false (with a reason in
+  // error) if the file can not be opened or is not a binary snapshot.
+  bool open(const std::string &fileName, std::string &error) {
+    file.open(fileName, std::ios::binary);
+    if (!file.is_open()) {
+      error = "can not open file";
+      return false;
+    }
+    char start[sizeof(magic)];
+    uint32_t fileVersion = 0;
+    if (!file.read(start, sizeof(magic)) ||
+        std::memcmp(start, magic, sizeof(magic)) != 0 || !get(fileVersion)) {
+      error = "not a binary snapshot";
+      return false;
+    }
+    if (fileVersion != version) {
+      error = "unknown binary snapshot version " + std::to_string(fileVersion);
+      return false;
+    }
+    uint32_t columnCount = 0;
+    if (!get(header.genomeLength) || !get(header.alphabetSize) ||
+        !get(header.bitsPerSite) || !get(header.populationSize) ||
+        !getString(header.genomeName) || !get(columnCount) ||
+        columnCount > maxNameLength) {
+      error = "truncated header";
+      return false;
+    }
+    header.columns.resize(columnCount);
+    for (auto &column : header.columns) {
+      if (!getString(column)) {
+        error = "truncated header";
+        return false;
+      }
+    }
+    if (header.bitsPerSite != bitsForAlphabet(header.alphabetSize)) {
+      error = "bits per site does not match alphabet size";
+      return false;
+    }
+    recordsRead = 0;
+    return true;
+  }
+
+  const Header &getHeader() const { return header; }
+
+  // read the next record into record. Returns false once all records have
+  // been read, or (with a reason in error) if the file is truncated.
+  bool read(Record &record, std::string &error) {
+    if (recordsRead == header.populationSize) {
+      return false;
+    }
+    buffer.resize(header.recordBytes());
+    if (!file.read((char *)buffer.data(), buffer.size())) {
+      error = "truncated after " + std::to_string(recordsRead) + " records";
+      return false;
+    }
+    const uint8_t *in = buffer.data();
+    std::memcpy(&record.ID, in, sizeof(record.ID));
+    in += sizeof(record.ID);
+    std::memcpy(&record.siteCount, in, sizeof(record.siteCount));
+    in += sizeof(record.siteCount);
+    if (record.siteCount > header.genomeLength) {
+      error = "record " + std::to_string(recordsRead) + " has too many sites";
+      return false;
+    }
+    record.genome.assign(in, in + header.genomeBytes());
+    in += header.genomeBytes();
+    record.values.resize(header.columns.size());
+    std::memcpy(record.values.data(), in,
+                record.values.size() * sizeof(double));
+    recordsRead++;
+    return true;
+  }
+
+private:
+  std::ifstream file;
+  Header header;
+  uint64_t recordsRead = 0;
+  std::vector<uint8_t> buffer;
+
+  template <class Number> bool get(Number &value) {
+    return (bool)file.read((char *)&value, sizeof(value));
+  }
+  bool getString(std::string &s) {
+    uint32_t length = 0;
+    if (!get(length) || length > maxNameLength) {
+      return false;
+    }
+    s.resize(length);
+    return length == 0 || (bool)file.read(&s[0], length);
+  }
+};
+
+} // namespace BinarySnapshot
@@ -0,0 +1,184 @@
+//  MABE is a product of The Hintze Lab @ MSU
+//     for general research information:
+//         hintzelab.msu.edu
+//     for MABE documentation:
+//         github.com/Hintzelab/MABE/wiki
+//
+//  Copyright (c) 2015 Michigan State University. All rights reserved.
+//     to view the full license, visit:
+//         github.com/Hintzelab/MABE/wiki/License
+
+// This file provides the binary streams used to write and read checkpoint
+// files (see GLOBAL-checkpointInterval and GLOBAL-resumeFrom). Modules that
+// keep state across updates write it with a Writer and read it back, in
+// the same order, with a Reader. It only depends on the standard library.
+//
+// Numbers are written as their bytes, in the byte order of the machine that
+// wrote the file. Strings and vectors are written as their length (uint64)
+// followed by their elements.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Checkpoint {
+
+const char magic[8] = {'M', 'A', 'B', 'E', 'C', 'K', 'P', 'T'};
+const uint32_t version = 2;
+
+class Writer {
+public:
+  // the checkpoint is written to fileName + ".tmp" and only replaces
+  // fileName in close(), so an interrupted write leaves the last checkpoint
+  // in place. Returns false if the file can not be opened.
+  bool open(const std::string &fileName_) {
+    fileName = fileName_;
+    file.open(fileName + ".tmp", std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+      return false;
+    }
+    file.write(magic, sizeof(magic));
+    put(version);
+    return (bool)file;
+  }
+
+  template <class Number> void put(const Number &value) {
+    static_assert(std::is_arithmetic<Number>::value,
+                  "Checkpoint::Writer::put only writes numbers");
+    file.write((const char *)&value, sizeof(value));
+  }
+
+  void put(const std::string &s) {
+    put((uint64_t)s.size());
+    file.write(s.data(), s.size());
+  }
+
+  template <class Number> void put(const std::vector<Number> &values) {
+    static_assert(std::is_arithmetic<Number>::value,
+                  "Checkpoint::Writer::put only writes vectors of numbers");
+    put((uint64_t)values.size());
+    file.write((const char *)values.data(), values.size() * sizeof(Number));
+  }
+
+  void put(const std::vector<bool> &values) {
+    put((uint64_t)values.size());
+    for (bool value : values) {
+      put((uint8_t)value);
+    }
+  }
+
+  void put(const std::vector<std::string> &values) {
+    put((uint64_t)values.size());
+    for (auto const &value : values) {
+      put(value);
+    }
+  }
+
+  // returns false if anything failed to write
+  bool close() {
+    file.close();
+    if (file.fail()) {
+      return false;
+    }
+    std::remove(fileName.c_str());
+    return std::rename((fileName + ".tmp").c_str(), fileName.c_str()) == 0;
+  }
+
+private:
+  std::ofstream file;
+  std::string fileName;
+};
+
+class Reader {
+public:
+  // open fileName and check that it is a checkpoint. Returns false if it can
+  // not be opened or is not a checkpoint of this version.
+  bool open(const std::string &fileName) {
+    file.open(fileName, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+      return false;
+    }
+    remaining = (uint64_t)file.tellg();
+    file.seekg(0);
+    char start[sizeof(magic)];
+    uint32_t fileVersion = 0;
+    read(start, sizeof(magic));
+    get(fileVersion);
+    return good && std::memcmp(start, magic, sizeof(magic)) == 0 &&
+           fileVersion == version;
+  }
+
+  // false once a read has run past the end of the file; everything read
+  // after that is zero or empty
+  bool ok() const { return good; }
+
+  template <class Number> void get(Number &value) {
+    static_assert(std::is_arithmetic<Number>::value,
+                  "Checkpoint::Reader::get only reads numbers");
+    value = Number();
+    read((char *)&value, sizeof(value));
+  }
+
+  void get(std::string &s) {
+    uint64_t size = getSize(1);
+    s.assign(size, '\0');
+    read(&s[0], size);
+  }
+
+  template <class Number> void get(std::vector<Number> &values) {
+    static_assert(std::is_arithmetic<Number>::value,
+                  "Checkpoint::Reader::get only reads vectors of numbers");
+    values.assign(getSize(sizeof(Number)), Number());
+    read((char *)values.data(), values.size() * sizeof(Number));
+  }
+
+  void get(std::vector<bool> &values) {
+    values.assign(getSize(1), false);
+    for (size_t i = 0; i < values.size(); i++) {
+      uint8_t value;
+      get(value);
+      values[i] = value;
+    }
+  }
+
+  void get(std::vector<std::string> &values) {
+    values.assign(getSize(sizeof(uint64_t)), std::string());
+    for (auto &value : values) {
+      get(value);
+    }
+  }
+
+  // a count of elements of elementSize bytes each, 0 if the rest of the file
+  // could not hold that many
+  uint64_t getSize(size_t elementSize) {
+    uint64_t size;
+    get(size);
+    if (size > remaining / elementSize) {
+      good = false;
+      return 0;
+    }
+    return size;
+  }
+
+private:
+  std::ifstream file;
+  uint64_t remaining = 0; // bytes not yet read
+  bool good = true;
+
+  void read(char *to, size_t bytes) {
+    if (!good || bytes > remaining || !file.read(to, bytes)) {
+      good = false;
+      std::memset(to, 0, bytes);
+      return;
+    }
+    remaining -= bytes;
+  }
+};
+
+} // namespace Checkpoint
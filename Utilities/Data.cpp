@@ -10,81 +10,422 @@
 
 #include "Data.h"
 
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <fstream>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#if defined(__APPLE__)
+#include <dispatch/dispatch.h>
+#else
+#include <semaphore.h>
+#endif
 
 
 // global variables that should be accessible to all
 // set<string> FileManager::dataFilesCreated;
 
 std::string FileManager::outputPrefix;
+size_t FileManager::bufferSize = 0;
 std::map<std::string, std::vector<std::string>> FileManager::fileColumns;
-std::map<std::string, std::ofstream>
-    FileManager::files; // list of files (NAME,ofstream)
-std::map<std::string, bool>
-    FileManager::fileStates; // list of files states (NAME,open?)
+std::map<std::string, FileManager::OutputFile>
+    FileManager::files; // list of files (NAME,file)
 std::map<std::string, int> DataMap::knownOutputBehaviors = {
     {"LIST", LIST},     {"AVE", AVE},     {"SUM", SUM}, {"PROD", PROD},
     {"STDERR", STDERR}, {"FIRST", FIRST}, {"VAR", VAR}};
 
+namespace {
+
+// a counting semaphore whose post() is async-signal-safe, so a signal
+// handler can wake the background thread
+class Wakeup {
+#if defined(__APPLE__)
+  dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+
+public:
+  void post() { dispatch_semaphore_signal(semaphore); }
+  void wait() { dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER); }
+#else
+  sem_t semaphore;
+
+public:
+  Wakeup() { sem_init(&semaphore, 0, 0); }
+  ~Wakeup() { sem_destroy(&semaphore); }
+  void post() { sem_post(&semaphore); }
+  void wait() {
+    while (sem_wait(&semaphore) != 0 && errno == EINTR) {
+    }
+  }
+#endif
+};
+
+// the background thread that writes full buffers. lock guards
+// FileManager::files, their buffers and the jobs; the streams of files
+// with jobs waiting belong to the background thread until it is idle.
+class BackgroundWriter {
+public:
+  std::mutex lock;
+  std::atomic<bool> flushRequested{false};
+  std::atomic<bool> running{false};
+  Wakeup wake; // posted for every job, flush request and stop
+
+  ~BackgroundWriter() {
+    // exit() may be called with the lock held (by this thread or another
+    // one); then nothing more can be written safely, so the thread is left
+    // to die with the process
+    std::unique_lock<std::mutex> held(lock, std::try_to_lock);
+    if (!held.owns_lock()) {
+      if (thread.joinable()) {
+        thread.detach();
+      }
+      return;
+    }
+    queueAll();
+    if (!thread.joinable()) {
+      return;
+    }
+    stopping = true;
+    wake.post();
+    held.unlock();
+    thread.join();
+  }
+
+  // hand the buffer of file to the background thread (lock must be held)
+  void queue(FileManager::OutputFile &file) {
+    if (!thread.joinable()) {
+      thread = std::thread([this] { writeLoop(); });
+      running = true;
+    }
+    jobs.emplace_back(&file, std::move(file.buffer));
+    file.buffer.clear();
+    wake.post();
+  }
+
+  // hand every non-empty buffer to the background thread (lock must be held)
+  void queueAll() {
+    for (auto &file : FileManager::files) {
+      if (!file.second.buffer.empty()) {
+        queue(file.second);
+      }
+    }
+  }
+
+  // wait until every queued buffer has been written (lock must be held)
+  void waitUntilIdle(std::unique_lock<std::mutex> &held) {
+    idle.wait(held, [this] { return jobs.empty() && !writing; });
+  }
+
+private:
+  std::deque<std::pair<FileManager::OutputFile *, std::string>> jobs;
+  bool writing = false;
+  bool stopping = false;
+  std::condition_variable idle;
+  std::thread thread;
+
+  void writeLoop() {
+    std::unique_lock<std::mutex> held(lock, std::defer_lock);
+    while (true) {
+      wake.wait();
+      held.lock();
+      bool flushing = flushRequested;
+      if (flushing) {
+        queueAll();
+      }
+      while (!jobs.empty()) {
+        auto job = std::move(jobs.front());
+        jobs.pop_front();
+        writing = true;
+        held.unlock();
+        job.first->stream.write(job.second.data(), job.second.size());
+        job.first->stream.flush();
+        held.lock();
+        writing = false;
+      }
+      if (flushing) {
+        flushRequested = false;
+      }
+      idle.notify_all();
+      if (stopping) {
+        running = false;
+        return;
+      }
+      held.unlock();
+    }
+  }
+};
+
+// defined after FileManager::files so it is destroyed (and writes what is
+// left) first
+BackgroundWriter writer;
+
+// the last file written to, so repeated writes to one file skip the lookup
+std::string lastFileName;
+FileManager::OutputFile *lastFile = nullptr;
+
+// write everything buffered and wait for it (lock must be held)
+void flushLocked(std::unique_lock<std::mutex> &held) {
+  writer.queueAll();
+  writer.waitUntilIdle(held);
+  for (auto &file : FileManager::files) {
+    if (file.second.open) {
+      file.second.stream.flush();
+    }
+  }
+}
+
+} // namespace
+
 void FileManager::writeToFile(const std::string &fileName,
                               const std::string &data,
                               const std::string &header) {
-  openFile(
+  std::unique_lock<std::mutex> held(writer.lock);
+  auto &file = openFileLocked(
       fileName,
       header); // make sure that the file is open and ready to be written to
-  files[fileName] << data << "\n" << std::flush;
+  if (bufferSize == 0) {
+    file.stream << data << "\n" << std::flush;
+    return;
+  }
+  file.buffer.append(data);
+  file.buffer.push_back('\n');
+  if (file.buffer.size() >= bufferSize) {
+    writer.queue(file);
+  }
 }
 
 void FileManager::openFile(const std::string &fileName, const std::string &header) {
-  if (files.find(fileName) ==
-      files.end()) { // if file has not be initialized yet
-    files.emplace(make_pair(fileName, std::ofstream())); // make an ofstream for the
-                                                    // new file and place in
-                                                    // FileManager::files
-    files[fileName].open(
+  std::unique_lock<std::mutex> held(writer.lock);
+  openFileLocked(fileName, header);
+}
+
+FileManager::OutputFile &
+FileManager::openFileLocked(const std::string &fileName,
+                            const std::string &header) {
+  if (lastFile != nullptr && lastFile->open && fileName == lastFileName) {
+    return *lastFile;
+  }
+  auto found = files.find(fileName);
+  if (found == files.end()) { // if file has not be initialized yet
+    auto &file = files[fileName]; // make an OutputFile for the new file
+    file.stream.open(
         std::string(outputPrefix) +
-        fileName);               // clear file contents and open in write mode
-    fileStates[fileName] = true; // this file is now open
+        fileName); // clear file contents and open in write mode
+    file.open = true; // this file is now open
     if (!header.empty()) { // if there is a header string, write this to the new
                            // file
-      files[fileName] << header << "\n";
+      if (bufferSize == 0) {
+        file.stream << header << "\n";
+      } else {
+        file.buffer.append(header);
+        file.buffer.push_back('\n');
+      }
     }
+    found = files.find(fileName);
   }
-  if (fileStates[fileName] == false) { // if file is closed ...
-    files[fileName].open(std::string(outputPrefix) + fileName,
-                         std::ios::out |
-                             std::ios::app); // open file in append mode
+  auto &file = found->second;
+  if (!file.open) { // if file is closed ...
+    file.stream.open(std::string(outputPrefix) + fileName,
+                     std::ios::out | std::ios::app); // open file in append mode
+    file.open = true;
   }
+  lastFileName = fileName;
+  lastFile = &file;
+  return file;
 }
 
 void FileManager::closeFile(const std::string &fileName) {
+  std::unique_lock<std::mutex> held(writer.lock);
   if (files.find(fileName) == files.end()) {
+    held.unlock(); // exit() flushes the other files, which takes the lock
     std::cout << "  In FileManager::closeFile :: ERROR, attempt to close file '"
          << fileName
          << "' but this file has not been opened or created! Exiting." << std::endl;
     exit(1);
   }
-  files[fileName].close();
-  fileStates[fileName] = false; // make a note that this file is closed
+  flushLocked(held);
+  files[fileName].stream.close();
+  files[fileName].open = false; // make a note that this file is closed
+}
+
+void FileManager::flush() {
+  std::unique_lock<std::mutex> held(writer.lock);
+  flushLocked(held);
+}
+
+void FileManager::requestFlush(double waitSeconds) {
+  writer.flushRequested = true;
+  writer.wake.post();
+  // only the background thread can answer (nothing is buffered without it)
+  for (double waited = 0; waited < waitSeconds && writer.running &&
+                          writer.flushRequested;
+       waited += .01) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+void FileManager::saveCheckpoint(Checkpoint::Writer &checkpoint) {
+  std::unique_lock<std::mutex> held(writer.lock);
+  flushLocked(held); // so the files on disk hold everything written so far
+  checkpoint.put((uint64_t)files.size());
+  for (auto &file : files) {
+    checkpoint.put(file.first);
+    std::ifstream written(std::string(outputPrefix) + file.first,
+                          std::ios::binary | std::ios::ate);
+    uint64_t length = (uint64_t)written.tellg();
+    checkpoint.put(length);
+    bool hasColumns = fileColumns.find(file.first) != fileColumns.end();
+    checkpoint.put((uint8_t)hasColumns);
+    checkpoint.put(hasColumns ? fileColumns[file.first]
+                              : std::vector<std::string>());
+  }
+}
+
+void FileManager::loadCheckpoint(Checkpoint::Reader &checkpoint) {
+  uint64_t count = checkpoint.getSize(1);
+  for (uint64_t i = 0; i < count; i++) {
+    std::string fileName;
+    uint64_t length;
+    uint8_t hasColumns;
+    std::vector<std::string> columns;
+    checkpoint.get(fileName);
+    checkpoint.get(length);
+    checkpoint.get(hasColumns);
+    checkpoint.get(columns);
+    if (!checkpoint.ok()) {
+      return;
+    }
+    // drop anything written after the checkpoint, then treat the file as
+    // written and closed so the next write appends without a header
+    std::string path = std::string(outputPrefix) + fileName;
+    std::ifstream oldFile(path, std::ios::binary | std::ios::ate);
+    if (!oldFile.is_open() || (uint64_t)oldFile.tellg() < length) {
+      std::cout << "  ERROR :: in FileManager::loadCheckpoint, file " << path
+                << " is missing or shorter than when the checkpoint was "
+                   "written. Exiting."
+                << std::endl;
+      exit(1);
+    }
+    if ((uint64_t)oldFile.tellg() > length) {
+      std::string contents(length, '\0');
+      oldFile.seekg(0);
+      oldFile.read(&contents[0], length);
+      oldFile.close();
+      std::ofstream(path, std::ios::binary | std::ios::trunc)
+          .write(contents.data(), contents.size());
+    }
+    std::unique_lock<std::mutex> held(writer.lock);
+    files[fileName].open = false;
+    if (hasColumns) {
+      fileColumns[fileName] = columns;
+    }
+  }
+}
+
+DataMap::Key DataMap::keyOf(const std::string &name) {
+  // each thread remembers the keys it has seen, so only new names take the
+  // lock. Keys are never removed, so the names they point to stay valid.
+  thread_local std::unordered_map<std::string, Key> seen;
+  auto found = seen.find(name);
+  if (found != seen.end()) {
+    return found->second;
+  }
+  static std::mutex lock;
+  static std::unordered_map<std::string, Key> interned;
+  std::lock_guard<std::mutex> guard(lock);
+  auto entry = interned.find(name);
+  if (entry == interned.end()) {
+    entry = interned.emplace(name, Key()).first;
+    entry->second.id = (int)interned.size() - 1;
+    entry->second.name = &entry->first;
+  }
+  seen.emplace(name, entry->second);
+  return entry->second;
 }
 
 // copy constructor
-DataMap::DataMap(std::shared_ptr<DataMap> source) {
-  boolData = source->boolData;
-  doubleData = source->doubleData;
-  intData = source->intData;
-  stringData = source->stringData;
-  for (auto entry : source->inUse) {
-    inUse[entry.first] = entry.second;
-  }
-  // inUse = source->inUse; // replaced with for loop.
-  outputBehavior = source->outputBehavior;
+DataMap::DataMap(std::shared_ptr<DataMap> source) { *this = *source; }
+
+void DataMap::saveCheckpoint(Checkpoint::Writer &checkpoint) {
+  std::vector<const Column *> byName;
+  for (auto const &column : columns) {
+    byName.push_back(&column);
+  }
+  std::sort(byName.begin(), byName.end(),
+            [](const Column *a, const Column *b) {
+              return *a->key.name < *b->key.name;
+            });
+  checkpoint.put((uint64_t)byName.size());
+  for (auto column : byName) {
+    auto first = column->start, last = column->start + column->size;
+    checkpoint.put(*column->key.name);
+    checkpoint.put((int32_t)column->type);
+    auto type = listType(column->type);
+    if (type == BOOL) {
+      checkpoint.put(std::vector<bool>(boolValues.begin() + first,
+                                       boolValues.begin() + last));
+    } else if (type == DOUBLE) {
+      checkpoint.put(std::vector<double>(doubleValues.begin() + first,
+                                         doubleValues.begin() + last));
+    } else if (type == INT) {
+      checkpoint.put(std::vector<int>(intValues.begin() + first,
+                                      intValues.begin() + last));
+    } else {
+      checkpoint.put(std::vector<std::string>(stringValues.begin() + first,
+                                              stringValues.begin() + last));
+    }
+  }
+  checkpoint.put((uint64_t)byName.size());
+  for (auto column : byName) {
+    checkpoint.put(*column->key.name);
+    checkpoint.put((int32_t)column->outputBehavior);
+  }
 }
 
+void DataMap::loadCheckpoint(Checkpoint::Reader &checkpoint) {
+  clearMap();
+  uint64_t count = checkpoint.getSize(1);
+  for (uint64_t i = 0; i < count && checkpoint.ok(); i++) {
+    std::string key;
+    int32_t type;
+    checkpoint.get(key);
+    checkpoint.get(type);
+    if (listType((dataMapType)type) == BOOL) {
+      std::vector<bool> values;
+      checkpoint.get(values);
+      set(key, values);
+    } else if (listType((dataMapType)type) == DOUBLE) {
+      std::vector<double> values;
+      checkpoint.get(values);
+      set(key, values);
+    } else if (listType((dataMapType)type) == INT) {
+      std::vector<int> values;
+      checkpoint.get(values);
+      set(key, values);
+    } else {
+      std::vector<std::string> values;
+      checkpoint.get(values);
+      set(key, values);
+    }
+    findColumn(keyOf(key))->type = (dataMapType)type;
+  }
+  count = checkpoint.getSize(1);
+  for (uint64_t i = 0; i < count && checkpoint.ok(); i++) {
+    std::string key;
+    int32_t behavior;
+    checkpoint.get(key);
+    checkpoint.get(behavior);
+    setOutputBehavior(key, behavior);
+  }
+}
 
 // take two strings (header and data), and a list of keys, and whether or not to
 // save "{LIST}"s. convert data from data map to header and data strings
@@ -97,19 +438,21 @@ void DataMap::constructHeaderAndDataStrings(std::string &headerStr, std::string
   unsigned int OB; // holds output behavior so it can be over ridden for ave file output!
   if (!keys.empty()) { // if keys is not empty
     for (auto const &i : keys) {
-      typeOfKey = findKeyInData(i);
-      if (typeOfKey == NONE) {
+      Key key = keyOf(i);
+      Column *column = findColumn(key);
+      if (column == nullptr) {
         std::cout << "  in DataMap::writeToFile() - key \"" << i
              << "\" can not be found in data map!\n  exiting." << std::endl;
         exit(1);
       }
+      typeOfKey = column->type;
 
       // the following code makes use of bit masks! in short, AVE,SUM,LIST,etc
       // each use only one bit of an int.
       // therefore if we apply that mask the the outputBehavior, we can see if
       // that type of output is needed.
 
-      OB = outputBehavior[i];
+      OB = column->outputBehavior;
 
       if (typeOfKey == STRING || typeOfKey == STRINGSOLO) {
         if (!(OB == LIST || OB == FIRST || OB == NO_OUTPUT)) {
@@ -135,60 +478,36 @@ void DataMap::constructHeaderAndDataStrings(std::string &headerStr, std::string
       if (OB & FIRST) { // save first (only?) element in vector with key as
                         // column name
         headerStr += FileManager::separator + i;
-        if (typeOfKey == BOOL || typeOfKey == BOOLSOLO) {
-          if (!getBoolVector(i).empty()) {
-            dataStr += FileManager::separator + to_string(getBoolVector(i)[0]);
-          } else {
-            dataStr += '0';
-            std::cout << "  WARNING!! In DataMap::constructHeaderAndDataStrings :: "
-                    "while getting value for FIRST with key \""
-                 << i << "\" vector is empty!" << std::endl;
-          }
-        }
-        if (typeOfKey == DOUBLE || typeOfKey == DOUBLESOLO) {
-          if (!getDoubleVector(i).empty()) {
-            dataStr +=
-                FileManager::separator + std::to_string(getDoubleVector(i)[0]);
-          } else {
-            dataStr += '0';
-            std::cout << "  WARNING!! In DataMap::constructHeaderAndDataStrings :: "
-                    "while getting value for FIRST with key \""
-                 << i << "\" vector is empty!" << std::endl;
-          }
-        }
-        if (typeOfKey == INT || typeOfKey == INTSOLO) {
-          if (!getIntVector(i).empty()) {
-            dataStr +=
-                FileManager::separator + std::to_string(getIntVector(i)[0]);
-          } else {
-            dataStr += '0';
-            std::cout << "  WARNING!! In DataMap::constructHeaderAndDataStrings :: "
-                    "while getting value for FIRST with key \""
-                 << i << "\" vector is empty!" << std::endl;
-          }
-        }
-        if (typeOfKey == STRING || typeOfKey == STRINGSOLO) {
-          if (!getStringVector(i).empty()) {
-            dataStr += FileManager::separator + (std::string)"\"" + getStringVector(i)[0] + (std::string)"\"";
-          } else {
-            dataStr += (std::string)"\"0\"";
-            std::cout << "  WARNING!! In DataMap::constructHeaderAndDataStrings :: "
-                    "while getting value for FIRST with key \""
-                 << i << "\" vector is empty!" << std::endl;
-          }
+        if (column->size == 0) {
+          dataStr += listType(typeOfKey) == STRING ? "\"0\"" : "0";
+          std::cout << "  WARNING!! In DataMap::constructHeaderAndDataStrings :: "
+                  "while getting value for FIRST with key \""
+               << i << "\" vector is empty!" << std::endl;
+        } else if (listType(typeOfKey) == BOOL) {
+          dataStr += FileManager::separator +
+                     std::to_string((int)boolValues[column->start]);
+        } else if (listType(typeOfKey) == DOUBLE) {
+          dataStr += FileManager::separator +
+                     std::to_string(doubleValues[column->start]);
+        } else if (listType(typeOfKey) == INT) {
+          dataStr += FileManager::separator +
+                     std::to_string(intValues[column->start]);
+        } else {
+          dataStr += FileManager::separator + (std::string)"\"" +
+                     stringValues[column->start] + (std::string)"\"";
         }
       }
       if (OB & AVE) { // key_AVE = ave of vector (will error if of type string!)
         headerStr += FileManager::separator + i + "_AVE";
-        dataStr += FileManager::separator + std::to_string(getAverage(i));
+        dataStr += FileManager::separator + std::to_string(getAverage(key));
       }
       if (OB & VAR) { // key_VAR = variance of vector (will error if of type string!)
         headerStr += FileManager::separator + i + "_VAR";
-        dataStr += FileManager::separator + std::to_string(getVariance(i));
+        dataStr += FileManager::separator + std::to_string(getVariance(key));
       }
       if (OB & SUM) { // key_SUM = sum of vector
         headerStr += FileManager::separator + i + "_SUM";
-        dataStr += FileManager::separator + std::to_string(getSum(i));
+        dataStr += FileManager::separator + std::to_string(getSum(key));
       }
       if (OB & PROD) { // key_PROD = product of vector
         std::cout << "  WARNING OUTPUT METHOD PROD IS HAS YET TO BE WRITTEN!"
@@ -200,7 +519,7 @@ void DataMap::constructHeaderAndDataStrings(std::string &headerStr, std::string
       }
       if (OB & LIST) { // key_LIST = save all elements in vector in csv list format
         headerStr += FileManager::separator + i + "_LIST";
-        dataStr += FileManager::separator + (std::string)"\"" + getStringOfVector(i) + (std::string)"\"";
+        dataStr += FileManager::separator + (std::string)"\"" + getStringOfVector(key) + (std::string)"\"";
       }
     }
     headerStr.erase(headerStr.begin()); // clip off the leading separator
@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <set>
@@ -20,16 +21,30 @@
 #include <unordered_map>
 #include <vector>
 
+#include "Checkpoint.h"
 #include "Utilities.h"
 
+// Output files are buffered: writeToFile appends to a per-file buffer, and
+// once a buffer holds bufferSize bytes it is handed to a background thread
+// that writes it. flush() writes everything and waits for it to reach the
+// files; it is called at the end of a run (archive(flush)), before
+// checkpoints and when a file is closed. requestFlush() asks the background
+// thread to do the same and may be called from a signal handler (ctrl-c). With a
+// bufferSize of 0 every line is written and flushed as it is given.
 class FileManager {
 public:
+  struct OutputFile {
+    std::ofstream stream;
+    std::string buffer; // written but not yet handed to the background thread
+    bool open = false;
+  };
+
   static std::map<std::string, std::vector<std::string>>
       fileColumns;                     // list of files (NAME,LIST OF COLUMNS)
-  static std::map<std::string, std::ofstream> files;  // list of files (NAME,ofstream)
-  static std::map<std::string, bool> fileStates; // list of files states (NAME,open?)
+  static std::map<std::string, OutputFile> files; // list of files (NAME,file)
 
   static std::string outputPrefix;
+  static size_t bufferSize; // bytes held per file before it is written
 
   static const char separator = ',';
 
@@ -43,8 +58,31 @@ public:
                                                    // to file if file is new and
                                                    // header is provided
   static void closeFile(const std::string &fileName);   // close file
+
+  static void flush();        // write all buffered data and wait for it
+  // async-signal-safe (see above); waits up to waitSeconds for the flush
+  static void requestFlush(double waitSeconds = 0);
+
+  // record every file written so far (with its columns and current length);
+  // loadCheckpoint cuts the files back to those lengths and appends to them
+  static void saveCheckpoint(Checkpoint::Writer &checkpoint);
+  static void loadCheckpoint(Checkpoint::Reader &checkpoint);
+
+private:
+  static OutputFile &openFileLocked(const std::string &fileName,
+                                    const std::string &header);
 };
 
+// A DataMap holds named lists of bool, double, int or string values, and how
+// each should be written to file (outputBehavior).
+//
+// Key names are interned: the first time a name is seen it is given a Key
+// (a small integer ID shared by every DataMap in the run). A DataMap keeps
+// one contiguous array of values per type and a list of columns, sorted by
+// Key, that say where each key's values are in those arrays. Code that reads
+// or writes the same key in many DataMaps (e.g. every organism in a
+// population) can look the Key up once with keyOf and use the Key versions
+// of the functions below; the string versions look the Key up on each call.
 class DataMap {
 public:
   enum outputBehaviors {
@@ -57,11 +95,14 @@ public:
     VAR = 64,
 	 NO_OUTPUT = 128
   };                               // 0 = do not save or default..?
-  std::map<std::string, int> outputBehavior; // Defines how each element should be written
-                                   // to file - if element not found, LIST
-                                   // (write out list) is used.
   static std::map<std::string, int> knownOutputBehaviors;
 
+  struct Key {
+    int id = -1;
+    const std::string *name = nullptr; // the interned name
+  };
+  static Key keyOf(const std::string &name); // intern name (thread safe)
+
 private:
   enum dataMapType {
     NONE = 0,
@@ -75,13 +116,187 @@ private:
     STRINGSOLO = 14
   }; // NONE = not found in this data map
 
-  std::unordered_map<std::string, std::vector<bool>> boolData;
-  std::unordered_map<std::string, std::vector<double>> doubleData;
-  std::unordered_map<std::string, std::vector<int>> intData;
-  std::unordered_map<std::string, std::vector<std::string>> stringData;
+  struct Column {
+    Key key;
+    dataMapType type;
+    int outputBehavior; // Defines how this element should be written to file
+    size_t start;       // index of the first value in the array for type
+    size_t size;        // number of values
+  };
+
+  std::vector<Column> columns; // sorted by key.id
+  std::vector<bool> boolValues;
+  std::vector<double> doubleValues;
+  std::vector<int> intValues;
+  std::vector<std::string> stringValues;
+
+  std::vector<bool> &valuesOf(bool) { return boolValues; }
+  std::vector<double> &valuesOf(double) { return doubleValues; }
+  std::vector<int> &valuesOf(int) { return intValues; }
+  std::vector<std::string> &valuesOf(const std::string &) {
+    return stringValues;
+  }
+  static dataMapType listTypeOf(bool) { return BOOL; }
+  static dataMapType listTypeOf(double) { return DOUBLE; }
+  static dataMapType listTypeOf(int) { return INT; }
+  static dataMapType listTypeOf(const std::string &) { return STRING; }
+  // the output behavior given to lists by set and append
+  static int listBehaviorOf(bool) { return LIST | AVE; }
+  static int listBehaviorOf(double) { return LIST | AVE; }
+  static int listBehaviorOf(int) { return LIST | AVE; }
+  static int listBehaviorOf(const std::string &) { return LIST; }
+
+  // BOOLSOLO -> BOOL, etc.
+  static dataMapType listType(dataMapType type) {
+    return type > STRING ? (dataMapType)(type - 10) : type;
+  }
+
+  // the column for key, nullptr if key is not in this data map
+  inline Column *findColumn(Key key) {
+    auto found = std::lower_bound(
+        columns.begin(), columns.end(), key.id,
+        [](const Column &column, int id) { return column.key.id < id; });
+    return (found != columns.end() && found->key.id == key.id) ? &*found
+                                                                : nullptr;
+  }
+
+  // add an empty column for key (which must not be in this data map)
+  inline Column &addColumn(Key key, dataMapType type, size_t arraySize) {
+    auto at = std::lower_bound(
+        columns.begin(), columns.end(), key.id,
+        [](const Column &column, int id) { return column.key.id < id; });
+    return *columns.insert(at, Column{key, type, 0, arraySize, 0});
+  }
+
+  // move the values of every other column of the same type that starts at or
+  // after position by shift
+  inline void shiftColumns(const Column &changed, size_t position,
+                           long shift) {
+    for (auto &column : columns) {
+      if (&column != &changed &&
+          listType(column.type) == listType(changed.type) &&
+          column.start >= position) {
+        column.start += shift;
+      }
+    }
+  }
+
+  // add [first, last) to the end of column's values
+  template <class T, class Iterator>
+  void insertValues(Column &column, Iterator first, Iterator last) {
+    auto &values = valuesOf(T());
+    size_t position = column.start + column.size;
+    size_t count = std::distance(first, last);
+    values.insert(values.begin() + position, first, last);
+    shiftColumns(column, position, (long)count);
+    column.size += count;
+  }
+
+  // remove all of column's values (the column stays)
+  template <class T> void eraseValues(Column &column) {
+    auto &values = valuesOf(T());
+    values.erase(values.begin() + column.start,
+                 values.begin() + column.start + column.size);
+    shiftColumns(column, column.start + column.size, -(long)column.size);
+    column.size = 0;
+  }
+
+  inline void typeError(const std::string &function, Key key,
+                        const char *given, dataMapType type) {
+    std::cout << "  ERROR :: in DataMap::" << function << " :: key \""
+              << *key.name << "\" was given " << given
+              << " but this key is already associated with "
+              << lookupDataMapTypeName(type) << ".\n  Exiting." << std::endl;
+    exit(1);
+  }
+
+  // replace the values of key with [first, last) (the set functions)
+  template <class T, class Iterator>
+  void setValues(Key key, Iterator first, Iterator last, bool solo,
+                 int behavior, const char *given) {
+    Column *column = findColumn(key);
+    if (column == nullptr) {
+      column = &addColumn(key, listTypeOf(T()), valuesOf(T()).size());
+    } else if (listType(column->type) != listTypeOf(T())) {
+      typeError("set", key, given, column->type);
+    } else {
+      eraseValues<T>(*column);
+    }
+    insertValues<T>(*column, first, last);
+    column->type =
+        solo ? (dataMapType)(listTypeOf(T()) + 10) : listTypeOf(T());
+    column->outputBehavior = behavior;
+  }
+
+  // add [first, last) to the values of key (the append functions).
+  // soloAllowed is false if key may not have been set with a single value
+  template <class T, class Iterator>
+  void appendValues(Key key, Iterator first, Iterator last, bool soloAllowed,
+                    const char *given) {
+    Column *column = findColumn(key);
+    if (column == nullptr) {
+      column = &addColumn(key, listTypeOf(T()), valuesOf(T()).size());
+    } else if (column->type != listTypeOf(T()) &&
+               !(soloAllowed && listType(column->type) == listTypeOf(T()))) {
+      typeError("append", key, given, column->type);
+    }
+    insertValues<T>(*column, first, last);
+    column->type = listTypeOf(T()); // may have been solo - make sure it's list
+    column->outputBehavior = listBehaviorOf(T());
+  }
+
+  // the column for key, or exit with an error if key has no numeric values
+  inline Column &numericColumn(Key key, const std::string &function) {
+    Column *column = findColumn(key);
+    if (column == nullptr) {
+      std::cout << "  in DataMap::" << function
+                << " attempt to get value from nonexistent key \""
+                << *key.name << "\".\n  Exiting." << std::endl;
+      exit(1);
+    }
+    if (listType(column->type) == STRING) {
+      std::cout << "  in DataMap::" << function
+                << " attempt to use with vector of type string associated key \""
+                << *key.name << "\".\n  Cannot average strings!\n  Exiting."
+                << std::endl;
+      exit(1);
+    }
+    return *column;
+  }
+
+  // call visit(double) for each value of a numeric column
+  template <class Visit> void forEachNumber(const Column &column, Visit visit) {
+    size_t end = column.start + column.size;
+    if (listType(column.type) == BOOL) {
+      for (size_t i = column.start; i < end; i++) {
+        visit((double)boolValues[i]);
+      }
+    } else if (listType(column.type) == DOUBLE) {
+      for (size_t i = column.start; i < end; i++) {
+        visit(doubleValues[i]);
+      }
+    } else {
+      for (size_t i = column.start; i < end; i++) {
+        visit((double)intValues[i]);
+      }
+    }
+  }
 
-  std::map<std::string, dataMapType>
-      inUse; // holds list of keys with type 1=bool, 2=double, 3=int, 4=string
+  template <class T> std::vector<T> getVector(Key key, const std::string &name) {
+    Column *column = findColumn(key);
+    if (column != nullptr && listType(column->type) == listTypeOf(T())) {
+      auto first = valuesOf(T()).begin() + column->start;
+      return std::vector<T>(first, first + column->size);
+    }
+    std::cout << "  in DataMap::get" << name << "Vector :: attempt to use get"
+              << name << "Vector with key \"" << *key.name
+              << "\" but this key is associated with type "
+              << (column == nullptr ? NONE : column->type) << "\n  exiting."
+              << std::endl;
+    std::cout << "  (if type is NONE, then the key was not found in dataMap)"
+              << std::endl;
+    exit(1);
+  }
 
 public:
   DataMap() = default;
@@ -89,29 +304,41 @@ public:
   // copy constructor
   DataMap(std::shared_ptr<DataMap> source);
 
+  inline void setOutputBehavior(Key key, int _outputBehavior) {
+    Column *column = findColumn(key);
+    if (column != nullptr) {
+      column->outputBehavior = _outputBehavior;
+    }
+  }
   inline void setOutputBehavior(const std::string &key, int _outputBehavior) {
-    outputBehavior[key] = _outputBehavior;
+    setOutputBehavior(keyOf(key), _outputBehavior);
+  }
+
+  // output behavior of key (0 if key is not in this data map)
+  inline int getOutputBehavior(const std::string &key) {
+    Column *column = findColumn(keyOf(key));
+    return column == nullptr ? 0 : column->outputBehavior;
   }
 
   // find key in this data map and return type (NONE = not found)
+  inline dataMapType findKeyInData(Key key) {
+    Column *column = findColumn(key);
+    return column == nullptr ? NONE : column->type;
+  }
   inline dataMapType findKeyInData(const std::string &key, bool printType = false) {
+    auto type = findKeyInData(keyOf(key));
     if (printType) {
-      std::cout << key << "is of type " << inUse[key] << std::endl;
-    }
-    if (inUse.find(key) != inUse.end()) {
-      return inUse[key];
-    } else {
-      return NONE;
+      std::cout << key << "is of type " << type << std::endl;
     }
+    return type;
   }
 
   // find key in this data map and return type (NONE = not found)
   inline bool isKeySolo(const std::string &key) {
-    if (inUse.find(key) != inUse.end()) {
-      return ((findKeyInData(key) == BOOLSOLO) ||
-              (findKeyInData(key) == DOUBLESOLO) ||
-              (findKeyInData(key) == INTSOLO) ||
-              (findKeyInData(key) == STRINGSOLO));
+    auto type = findKeyInData(key);
+    if (type != NONE) {
+      return type == BOOLSOLO || type == DOUBLESOLO || type == INTSOLO ||
+             type == STRINGSOLO;
     } else {
       std::cout << "  ERROR :: in DataMap::isKeySolo, key name " << key
            << " is not defined in DataMap. Exiting!" << std::endl;
@@ -138,324 +365,149 @@ public:
     }
   }
 
-  // return vector of strings will all keys in this data map
+  // return vector of strings will all keys in this data map, in
+  // alphabetical order
   inline std::vector<std::string> getKeys() {
     std::vector<std::string> keys;
-    for (auto e : inUse) {
-		 if (outputBehavior[e.first] != NO_OUTPUT) keys.push_back(e.first); // just push back the whole key
+    for (auto const &column : columns) {
+      if (column.outputBehavior != NO_OUTPUT) {
+        keys.push_back(*column.key.name);
+      }
     }
+    std::sort(keys.begin(), keys.end());
     return (keys);
   }
 
   // set functions (bool,double,int,string) that take a **single** value -
   // either make new map entry or replace existing
+  inline void set(Key key, const bool &value) {
+    setValues<bool>(key, &value, &value + 1, true, FIRST,
+                    "a bool");
+  }
+  inline void set(Key key, const double &value) {
+    setValues<double>(key, &value, &value + 1, true, FIRST,
+                      "a double");
+  }
+  inline void set(Key key, const int &value) {
+    setValues<int>(key, &value, &value + 1, true, FIRST,
+                   "an int");
+  }
+  inline void set(Key key, const std::string &value) {
+    setValues<std::string>(key, &value, &value + 1, true, FIRST,
+                           "a string");
+  }
   inline void set(const std::string &key, const bool &value) {
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == NONE || typeOfKey == BOOL ||
-        typeOfKey ==
-            BOOLSOLO) { // if key is unused or associates with correct type
-      boolData[key] = std::vector<bool>({value});
-      inUse[key] = BOOLSOLO; // since this is set with SET, it is a single value
-    } else {
-      std::cout << "  ERROR :: a call to DataMap::set was called where the key was "
-              "already in use with another type."
-           << std::endl;
-      std::cout << "  function was called with : key = \"" << key << "\" value = \""
-           << value << "\" where value is bool." << std::endl;
-      std::cout << "  but ... key is already associated with type "
-           << findKeyInData(key) << ". Exiting." << std::endl;
-      exit(1);
-    }
-	 setOutputBehavior(key, FIRST);
+    set(keyOf(key), value);
   }
   inline void set(const std::string &key, const double &value) {
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == NONE || typeOfKey == DOUBLE ||
-        typeOfKey ==
-            DOUBLESOLO) { // if key is unused or associates with correct type
-      doubleData[key] = std::vector<double>({value});
-      inUse[key] =
-          DOUBLESOLO; // since this is set with SET, it is a single value
-    } else {
-      std::cout << "  ERROR :: a call to DataMap::set was called where the key was "
-              "already in use with another type."
-           << std::endl;
-      std::cout << "  function was called with : key = \"" << key << "\" value = \""
-           << value << "\" where value is double." << std::endl;
-      std::cout << "  but ... key is already associated with type "
-           << findKeyInData(key) << ". Exiting." << std::endl;
-      exit(1);
-    }
-	 setOutputBehavior(key, FIRST);
+    set(keyOf(key), value);
   }
   inline void set(const std::string &key, const int &value) {
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == NONE || typeOfKey == INT ||
-        typeOfKey ==
-            INTSOLO) { // if key is unused or associates with correct type
-      intData[key] = std::vector<int>({value});
-      inUse[key] = INTSOLO; // since this is set with SET, it is a single value
-    } else {
-      std::cout << "  ERROR :: a call to DataMap::set was called where the key was "
-              "already in use with another type."
-           << std::endl;
-      std::cout << "  function was called with : key = \"" << key << "\" value = \""
-           << value << "\" where value is int." << std::endl;
-      std::cout << "  but ... key is already associated with type "
-           << findKeyInData(key) << ". Exiting." << std::endl;
-      exit(1);
-    }
-	 setOutputBehavior(key, FIRST);
+    set(keyOf(key), value);
   }
   inline void set(const std::string &key, const std::string &value) {
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == NONE || typeOfKey == STRING ||
-        typeOfKey ==
-            STRINGSOLO) { // if key is unused or associates with correct type
-      stringData[key] = std::vector<std::string>({value});
-      inUse[key] = STRINGSOLO;
-    } else {
-      std::cout << "  ERROR :: a call to DataMap::set was called where the key was "
-              "already in use with another type."
-           << std::endl;
-      std::cout << "  function was called with : key = \"" << key << "\" value = \""
-           << value << "\" where value is string." << std::endl;
-      std::cout << "  but ... key is already associated with type "
-           << findKeyInData(key) << ". Exiting." << std::endl;
-      exit(1);
-    }
-	 setOutputBehavior(key, FIRST);
+    set(keyOf(key), value);
   }
 
   // set functions (bool,double,int,string) that take a **vector** of value -
   // either make new map entry or replace existing
   // outputBehavior is set as though there was an append (i.e. list)
+  inline void set(Key key, const std::vector<bool> &value) {
+    setValues<bool>(key, value.begin(), value.end(), false, LIST | AVE,
+                    "a vector of bool");
+  }
+  inline void set(Key key, const std::vector<double> &value) {
+    setValues<double>(key, value.begin(), value.end(), false, LIST | AVE,
+                      "a vector of double");
+  }
+  inline void set(Key key, const std::vector<int> &value) {
+    setValues<int>(key, value.begin(), value.end(), false, LIST | AVE,
+                   "a vector of int");
+  }
+  inline void set(Key key, const std::vector<std::string> &value) {
+    setValues<std::string>(key, value.begin(), value.end(), false, LIST,
+                           "a vector of string");
+  }
   inline void set(const std::string &key, const std::vector<bool> &value) {
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == NONE || typeOfKey == BOOL ||
-        typeOfKey ==
-            BOOLSOLO) { // if key is unused or associates with correct type
-      boolData[key] = value;
-      inUse[key] = BOOL;
-    } else {
-      std::cout << "  ERROR :: a call to DataMap::set was called where the key was "
-              "already in use with another type."
-           << std::endl;
-      std::cout << "  function was called with : key = \"" << key
-           << "\" value is a vector of bool." << std::endl;
-      std::cout << "  but ... key is already associated with type "
-           << findKeyInData(key) << ". Exiting." << std::endl;
-      exit(1);
-    }
-	setOutputBehavior(key, LIST | AVE);
+    set(keyOf(key), value);
   }
   inline void set(const std::string &key, const std::vector<double> &value) {
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == NONE || typeOfKey == DOUBLE ||
-        typeOfKey ==
-            DOUBLESOLO) { // if key is unused or associates with correct type
-      doubleData[key] = value;
-      inUse[key] = DOUBLE;
-    } else {
-      std::cout << "  ERROR :: a call to DataMap::set was called where the key was "
-              "already in use with another type."
-           << std::endl;
-      std::cout << "  function was called with : key = \"" << key
-           << "\" value is a vector of double." << std::endl;
-      std::cout << "  but ... key is already associated with type "
-           << findKeyInData(key) << ". Exiting." << std::endl;
-      exit(1);
-    }
-	setOutputBehavior(key, LIST | AVE);
+    set(keyOf(key), value);
   }
   inline void set(const std::string &key, const std::vector<int> &value) {
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == NONE || typeOfKey == INT ||
-        typeOfKey ==
-            INTSOLO) { // if key is unused or associates with correct type
-      intData[key] = value;
-      inUse[key] = INT;
-    } else {
-      std::cout << "  ERROR :: a call to DataMap::set was called where the key was "
-              "already in use with another type."
-           << std::endl;
-      std::cout << "  function was called with : key = \"" << key
-           << "\" value is a vector of int." << std::endl;
-      std::cout << "  but ... key is already associated with type "
-           << findKeyInData(key) << ". Exiting." << std::endl;
-      exit(1);
-    }
-	setOutputBehavior(key, LIST | AVE);
+    set(keyOf(key), value);
   }
   inline void set(const std::string &key, const std::vector<std::string> &value) {
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == NONE || typeOfKey == STRING ||
-        typeOfKey ==
-            STRINGSOLO) { // if key is unused or associates with correct type
-      stringData[key] = value;
-      inUse[key] = STRING;
-    } else {
-      std::cout << "  ERROR :: a call to DataMap::set was called where the key was "
-              "already in use with another type."
-           << std::endl;
-      std::cout << "  function was called with : key = \"" << key
-           << "\" value is a vector of string." << std::endl;
-      std::cout << "  but ... key is already associated with type "
-           << findKeyInData(key) << ". Exiting." << std::endl;
-      exit(1);
-    }
-	setOutputBehavior(key, LIST);
+    set(keyOf(key), value);
   }
 
   // append a value to the end of vector associated with key. If key is not
   // found, start a new vector for key
+  inline void append(Key key, const bool &value) {
+    appendValues<bool>(key, &value, &value + 1, true,
+                       "a bool");
+  }
+  inline void append(Key key, const double &value) {
+    appendValues<double>(key, &value, &value + 1, true,
+                         "a double");
+  }
+  inline void append(Key key, const int &value) {
+    appendValues<int>(key, &value, &value + 1, true,
+                      "an int");
+  }
+  inline void append(Key key, const std::string &value) {
+    appendValues<std::string>(key, &value, &value + 1, true,
+                              "a string");
+  }
   inline void append(const std::string &key, const bool &value) {
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == NONE) { // this key is not in data map, use Set.
-      set(key, value);
-      inUse[key] = BOOL; // set the in use to be a list rather then a solo
-    } else if (typeOfKey == BOOL ||
-               typeOfKey == BOOLSOLO) { // if this key is in data map as a
-                                        // string, append to vector
-      boolData[key].push_back(value);
-      inUse[key] = BOOL;
-    } else {
-      std::cout << "  In DataMap::append :: attempt to append value \"" << value
-           << "\" of type bool to \"" << key
-           << "\" but this key is already associated with "
-           << lookupDataMapTypeName(typeOfKey) << ".\n  exiting." << std::endl;
-      exit(1);
-    }
-	setOutputBehavior(key, LIST | AVE);
+    append(keyOf(key), value);
   }
   inline void append(const std::string &key, const double &value) {
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == NONE) { // this key is not in data map, use Set.
-      set(key, value);
-      inUse[key] = DOUBLE; // set the in use to be a list rather then a solo
-    } else if (typeOfKey == DOUBLE ||
-               typeOfKey == DOUBLESOLO) { // if this key is in data map as a
-                                          // string, append to vector
-      doubleData[key].push_back(value);
-      inUse[key] = DOUBLE;
-    } else {
-      std::cout << "  In DataMap::append :: attempt to append value \"" << value
-           << "\" of type double to \"" << key
-           << "\" but this key is already associated with "
-           << lookupDataMapTypeName(typeOfKey) << ".\n  exiting." << std::endl;
-      exit(1);
-    }
-	setOutputBehavior(key, LIST | AVE);
+    append(keyOf(key), value);
   }
   inline void append(const std::string &key, const int &value) {
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == NONE) { // this key is not in data map, use Set.
-      set(key, value);
-      inUse[key] = INT; // set the in use to be a list rather then a solo
-    } else if (typeOfKey == INT ||
-               typeOfKey == INTSOLO) { // if this key is in data map as a
-                                       // string, append to vector
-      intData[key].push_back(value);
-      inUse[key] = INT; // set the in use to be a list rather then a solo
-    } else {
-      std::cout << "  In DataMap::append :: attempt to append value \"" << value
-           << "\" of type int to \"" << key
-           << "\" but this key is already associated with "
-           << lookupDataMapTypeName(typeOfKey) << ".\n  exiting." << std::endl;
-      exit(1);
-    }
-	setOutputBehavior(key, LIST | AVE);
+    append(keyOf(key), value);
   }
   inline void append(const std::string &key, const std::string &value) {
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == NONE) { // this key is not in data map, use Set.
-      set(key, value);
-      inUse[key] = STRING; // set the in use to be a list rather then a solo
-    } else if (typeOfKey == STRING ||
-               typeOfKey == STRINGSOLO) { // if this key is in data map as a
-                                          // string, append to vector
-      stringData[key].push_back(value);
-      inUse[key] = STRING; // set the in use to be a list rather then a solo
-    } else {
-      std::cout << "  In DataMap::append :: attempt to append value \"" << value
-           << "\" of type string to \"" << key
-           << "\" but this key is already associated with "
-           << lookupDataMapTypeName(typeOfKey) << ".\n  exiting." << std::endl;
-      exit(1);
-    }
-	setOutputBehavior(key, LIST);
+    append(keyOf(key), value);
   }
 
   // append a vector of values to the end of vector associated with key. If key
   // is not found, start a new vector for key
   inline void append(const std::string &key, const std::vector<bool> &value) {
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == NONE) { // this key is not in data map, use Set.
+    if (findKeyInData(key) == NONE) { // this key is not in data map, use Set.
       set(key, value);
-    } else if (typeOfKey == BOOL ||
-               typeOfKey == BOOLSOLO) { // if this key is in data map as a
-                                        // string, append to vector
-      boolData[key].insert(boolData[key].end(), value.begin(), value.end());
-      inUse[key] = BOOL; // may have been solo - make sure it's list
     } else {
-      std::cout << "  In DataMap::append :: attempt to append a vector of type bool "
-              "to \""
-           << key << "\" but this key is already associated with "
-           << lookupDataMapTypeName(typeOfKey) << ".\n  exiting." << std::endl;
-      exit(1);
+      appendValues<bool>(keyOf(key), value.begin(), value.end(), true,
+                         "a vector of bool");
     }
-	setOutputBehavior(key, LIST | AVE);
   }
   inline void append(const std::string &key, const std::vector<double> &value) {
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == NONE) { // this key is not in data map, use Set.
+    if (findKeyInData(key) == NONE) { // this key is not in data map, use Set.
       set(key, value);
-    } else if (typeOfKey == DOUBLE) { // if this key is in data map as a string,
-                                      // append to vector
-      doubleData[key].insert(doubleData[key].end(), value.begin(), value.end());
-      inUse[key] = DOUBLE; // may have been solo - make sure it's list
     } else {
-      std::cout << "  In DataMap::append :: attempt to append a vector of type "
-              "double to \""
-           << key << "\" but this key is already associated with "
-           << lookupDataMapTypeName(typeOfKey) << ".\n  exiting." << std::endl;
-      exit(1);
+      appendValues<double>(keyOf(key), value.begin(), value.end(), false,
+                           "a vector of double");
     }
-	setOutputBehavior(key, LIST | AVE);
   }
   inline void append(const std::string &key, const std::vector<int> &value) {
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == NONE) { // this key is not in data map, use Set.
+    if (findKeyInData(key) == NONE) { // this key is not in data map, use Set.
       set(key, value);
-    } else if (typeOfKey == INT) { // if this key is in data map as a string,
-                                   // append to vector
-      intData[key].insert(intData[key].end(), value.begin(), value.end());
-      inUse[key] = INT; // may have been solo - make sure it's list
     } else {
-      std::cout << "  In DataMap::append :: attempt to append a vector of type int "
-              "to \""
-           << key << "\" but this key is already associated with "
-           << lookupDataMapTypeName(typeOfKey) << ".\n  exiting." << std::endl;
-      exit(1);
+      appendValues<int>(keyOf(key), value.begin(), value.end(), false,
+                        "a vector of int");
     }
-	setOutputBehavior(key, LIST | AVE);
   }
   inline void append(const std::string &key, const std::vector<std::string> &value) {
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == NONE) { // this key is not in data map, use Set.
+    auto type = findKeyInData(key);
+    if (type == NONE) { // this key is not in data map, use Set.
       set(key, value);
-    } else if (typeOfKey == STRING) { // if this key is in data map as a string,
-                                      // concat new string with existing value
-		stringData[key] = { stringData[key][0] + value[0] };
-      inUse[key] = STRING; // may have been solo - make sure it's list
+    } else if (type == STRING) { // if this key is in data map as a string,
+                                 // concat new string with existing value
+      set(key, std::vector<std::string>{getStringVector(key)[0] + value[0]});
     } else {
-      std::cout << "  In DataMap::append :: attempt to append a vector of type "
-              "string to \""
-           << key << "\" but this key is already associated with "
-           << lookupDataMapTypeName(typeOfKey) << ".\n  exiting." << std::endl;
-      exit(1);
+      typeError("append", keyOf(key), "a vector of string", type);
     }
-	setOutputBehavior(key, LIST);
   }
 
   // merge contents of two data maps - if common keys are found behavior is determined by 'replace'
@@ -464,12 +516,15 @@ public:
   // replace 3 = keep the other value - if the same key exists in both maps, keep the other value
   // merge will attempt to merge outputBehavior
   inline void merge(DataMap otherDataMap, int replace = 0) {
-	  for (std::string key : otherDataMap.getKeys()) {
+	  for (auto const &otherColumn : otherDataMap.columns) {
+		  if (otherColumn.outputBehavior == NO_OUTPUT) {
+			  continue; // not in otherDataMap.getKeys()
+		  }
+		  Key key = otherColumn.key;
 		  dataMapType typeOfKey = findKeyInData(key);
-		  dataMapType typeOfOtherKey = otherDataMap.findKeyInData(key);
 		  if (replace == 0) { // no replacement allowed!
 			  if (typeOfKey != NONE) { // make sure key is not in both data maps
-				  std::cout << "  In DataMap::merge() - attempt to merge key: \"" << key
+				  std::cout << "  In DataMap::merge() - attempt to merge key: \"" << *key.name
 					  << "\" but key exists in both data maps and replace = 0!\n  Exiting." << std::endl;
 			  }
 		  }
@@ -480,295 +535,165 @@ public:
 		  //  or
 		  //   rule is keep current, and this key is not already in this data map (replace = 1)
 		  if (replace == 2 || replace == 0 || (replace == 1 && typeOfKey == NONE)) {
-			  if (typeOfOtherKey == BOOL || typeOfOtherKey == BOOLSOLO) {
+			  auto type = listType(otherColumn.type);
+			  if (type == BOOL) {
 				  set(key, otherDataMap.getBoolVector(key));
-				  outputBehavior[key] = otherDataMap.outputBehavior[key];
 			  }
-			  if (typeOfOtherKey == DOUBLE || typeOfOtherKey == DOUBLESOLO) {
+			  if (type == DOUBLE) {
 				  set(key, otherDataMap.getDoubleVector(key));
-				  outputBehavior[key] = otherDataMap.outputBehavior[key];
 			  }
-			  if (typeOfOtherKey == INT || typeOfOtherKey == INTSOLO) {
+			  if (type == INT) {
 				  set(key, otherDataMap.getIntVector(key));
-				  outputBehavior[key] = otherDataMap.outputBehavior[key];
 			  }
-			  if (typeOfOtherKey == STRING || typeOfOtherKey == STRINGSOLO) {
+			  if (type == STRING) {
 				  set(key, otherDataMap.getStringVector(key));
-				  outputBehavior[key] = otherDataMap.outputBehavior[key];
 			  }
+			  setOutputBehavior(key, otherColumn.outputBehavior);
 		  }
 	  }
   }
 
+  inline std::vector<bool> getBoolVector(Key key) {
+    return getVector<bool>(key, "Bool");
+  }
+  inline std::vector<double> getDoubleVector(Key key) {
+    return getVector<double>(key, "Double");
+  }
+  inline std::vector<int> getIntVector(Key key) {
+    return getVector<int>(key, "Int");
+  }
+  inline std::vector<std::string> getStringVector(Key key) {
+    return getVector<std::string>(key, "String");
+  }
   inline std::vector<bool> getBoolVector(
       const std::string &key) { // retrieve a double from a dataMap with "key"
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == BOOL || typeOfKey == BOOLSOLO) {
-      return boolData[key];
-    } else {
-      std::cout << "  in DataMap::getBoolVector :: attempt to use getBoolVector "
-              "with key \""
-           << key << "\" but this key is associated with type " << typeOfKey
-           << "\n  exiting." << std::endl;
-      std::cout << "  (if type is NONE, then the key was not found in dataMap)"
-           << std::endl;
-      exit(1);
-    }
+    return getBoolVector(keyOf(key));
   }
   inline std::vector<double> getDoubleVector(
       const std::string &key) { // retrieve a double from a dataMap with "key"
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == DOUBLE || typeOfKey == DOUBLESOLO) {
-      return doubleData[key];
-    } else {
-      std::cout << "  in DataMap::getDoubleVector :: attempt to use getDoubleVector "
-              "with key \""
-           << key << "\" but this key is associated with type " << typeOfKey
-           << "\n  exiting." << std::endl;
-      std::cout << "  (if type is NONE, then the key was not found in dataMap)"
-           << std::endl;
-      exit(1);
-    }
+    return getDoubleVector(keyOf(key));
   }
   inline std::vector<int> getIntVector(
       const std::string &key) { // retrieve a double from a dataMap with "key"
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == INT || typeOfKey == INTSOLO) {
-      return intData[key];
-    } else {
-      std::cout << "  in DataMap::getIntVector :: attempt to use getIntVector with "
-              "key \""
-           << key << "\" but this key is associated with type " << typeOfKey
-           << "\n  exiting." << std::endl;
-      std::cout << "  (if type is NONE, then the key was not found in dataMap)"
-           << std::endl;
-      exit(1);
-    }
+    return getIntVector(keyOf(key));
   }
   inline std::vector<std::string> getStringVector(
       const std::string &key) { // retrieve a double from a dataMap with "key"
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == STRING || typeOfKey == STRINGSOLO) {
-      return stringData[key];
-    } else {
-      std::cout << "  in DataMap::getStringVector :: attempt to use getStringVector "
-              "with key \""
-           << key << "\" but this key is associated with type " << typeOfKey
-           << "\n  exiting." << std::endl;
-      std::cout << "  (if type is NONE, then the key was not found in dataMap)"
-           << std::endl;
-      exit(1);
-    }
+    return getStringVector(keyOf(key));
   }
 
-  inline std::string getStringOfVector(const std::string &key) { // retrieve a string from
-                                                       // a dataMap with "key" -
-                                                       // if not already string,
-                                                       // will be converted
+  // retrieve a string from a dataMap with "key" - if not already string,
+  // will be converted
+  inline std::string getStringOfVector(Key key) {
     std::string returnString = "";
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey == NONE) {
-      std::cout << "  In DataMap::GetString() :: key \"" << key
+    Column *column = findColumn(key);
+    if (column == nullptr) {
+      std::cout << "  In DataMap::GetString() :: key \"" << *key.name
            << "\" is not in data map!\n  exiting." << std::endl;
       exit(1);
-    } else {
-      if (typeOfKey == BOOL || typeOfKey == BOOLSOLO) {
-        for (auto e : boolData[key]) {
-          returnString += to_string(e) + ",";
-        }
-      } else if (typeOfKey == DOUBLE || typeOfKey == DOUBLESOLO) {
-        for (auto e : doubleData[key]) {
-          returnString += std::to_string(e) + ",";
-        }
-      } else if (typeOfKey == INT || typeOfKey == INTSOLO) {
-        for (auto e : intData[key]) {
-          returnString += std::to_string(e) + ",";
-        }
-      } else if (typeOfKey == STRING || typeOfKey == STRINGSOLO) {
-        for (auto e : stringData[key]) {
-          returnString += e + ",";
-        }
+    }
+    size_t end = column->start + column->size;
+    auto type = listType(column->type);
+    for (size_t i = column->start; i < end; i++) {
+      if (type == BOOL) {
+        returnString += std::to_string((int)boolValues[i]) + ",";
+      } else if (type == DOUBLE) {
+        returnString += std::to_string(doubleValues[i]) + ",";
+      } else if (type == INT) {
+        returnString += std::to_string(intValues[i]) + ",";
+      } else {
+        returnString += stringValues[i] + ",";
       }
     }
     if (returnString.size() > 2) { // if vector was not empty
       returnString.pop_back();     // remove trailing ","
     }
-    returnString += "";
     return returnString;
   }
+  inline std::string getStringOfVector(const std::string &key) {
+    return getStringOfVector(keyOf(key));
+  }
 
   // get ave of values in a vector - must be bool, double or, int
-  inline double
-  getAverage(std::string key) { // not ref, we may need to change to a "{LIST}" key
-    dataMapType typeOfKey = findKeyInData(key);
+  inline double getAverage(Key key) {
+    auto &column = numericColumn(key, "getAverage");
     double returnValue = 0;
-    if (typeOfKey == BOOL || typeOfKey == BOOLSOLO) {
-      for (auto e : boolData[key]) {
-        returnValue += (double)e;
-      }
-      if (boolData[key].size() > 1) {
-        returnValue /= boolData[key].size();
-      } // else vector is  size 1, no div needed or vector is empty, returnValue
-        // will be 0
-    } else if (typeOfKey == DOUBLE || typeOfKey == DOUBLESOLO) {
-      for (auto e : doubleData[key]) {
-        returnValue += (double)e;
-      }
-      if (doubleData[key].size() > 1) {
-        returnValue /= doubleData[key].size();
-      } // else vector is  size 1, no div needed or vector is empty, returnValue
-        // will be 0
-    } else if (typeOfKey == INT || typeOfKey == INTSOLO) {
-      for (auto e : intData[key]) {
-        returnValue += (double)e;
-      }
-      if (intData[key].size() > 1) {
-        returnValue /= intData[key].size();
-      } // else vector is  size 1, no div needed or vector is empty, returnValue
-        // will be 0
-    } else if (typeOfKey == STRING || typeOfKey == STRINGSOLO) {
-      std::cout << "  in DataMap::getAverage attempt to use with vector of type "
-              "string associated key \""
-           << key << "\".\n  Cannot average strings!\n  Exiting." << std::endl;
-      exit(1);
-    } else if (typeOfKey == NONE) {
-      std::cout << "  in DataMap::getAverage attempt to get average from "
-              "nonexistent key \""
-           << key << "\".\n  Exiting." << std::endl;
-      exit(1);
-    }
+    forEachNumber(column, [&returnValue](double e) { returnValue += e; });
+    if (column.size > 1) {
+      returnValue /= column.size;
+    } // else vector is  size 1, no div needed or vector is empty, returnValue
+      // will be 0
     return returnValue;
   }
-
   inline double
-  getVariance(std::string key) { // not ref, we may need to change to a "{LIST}" key
-    dataMapType typeOfKey = findKeyInData(key);
+  getAverage(std::string key) { // not ref, we may need to change to a "{LIST}" key
+    return getAverage(keyOf(key));
+  }
+
+  inline double getVariance(Key key) {
+    auto &column = numericColumn(key, "getVariance");
     double averageValue(0);
     double varianceValue(0);
-    if (typeOfKey == BOOL || typeOfKey == BOOLSOLO) {
-      for (auto e : boolData[key]) {
-        averageValue += (double)e;
-      }
-      averageValue /= boolData[key].size();
-      for (auto e : boolData[key]) {
-        varianceValue +=
-            ((double)e - averageValue) * ((double)e - averageValue);
-      }
-      if (boolData[key].size() > 0)
-        varianceValue /= boolData[key].size() - 1;
-      else
-        varianceValue = 0;
-    } else if (typeOfKey == DOUBLE || typeOfKey == DOUBLESOLO) {
-      for (auto e : doubleData[key]) {
-        averageValue += (double)e;
-      }
-      averageValue /= doubleData[key].size();
-      for (auto e : doubleData[key]) {
-        varianceValue +=
-            ((double)e - averageValue) * ((double)e - averageValue);
-      }
-      if (doubleData[key].size() > 0)
-        varianceValue /= doubleData[key].size() - 1;
-      else
-        varianceValue = 0;
-    } else if (typeOfKey == INT || typeOfKey == INTSOLO) {
-      for (auto e : intData[key]) {
-        averageValue += (double)e;
-      }
-      averageValue /= intData[key].size();
-      for (auto e : intData[key]) {
-        varianceValue +=
-            ((double)e - averageValue) * ((double)e - averageValue);
-      }
-      if (intData[key].size() > 0)
-        varianceValue /= intData[key].size() - 1;
-      else
-        varianceValue = 0;
-    } else if (typeOfKey == STRING || typeOfKey == STRINGSOLO) {
-      std::cout << "  in DataMap::getVariance attempt to use with vector of type "
-              "string associated key \""
-           << key << "\".\n  Cannot average strings!\n  Exiting." << std::endl;
-      exit(1);
-    } else if (typeOfKey == NONE) {
-      std::cout << "  in DataMap::getVariance attempt to get value from nonexistent "
-              "key \""
-           << key << "\".\n  Exiting." << std::endl;
-      exit(1);
-    }
+    forEachNumber(column, [&averageValue](double e) { averageValue += e; });
+    averageValue /= column.size;
+    forEachNumber(column, [&varianceValue, averageValue](double e) {
+      varianceValue += (e - averageValue) * (e - averageValue);
+    });
+    if (column.size > 0)
+      varianceValue /= column.size - 1;
+    else
+      varianceValue = 0;
     return varianceValue;
   }
-
-  // get ave of values in a vector - must be bool, double or, int
   inline double
-  getSum(std::string key) { // not ref, we may need to change to a "{LIST}" key
-    dataMapType typeOfKey = findKeyInData(key);
+  getVariance(std::string key) { // not ref, we may need to change to a "{LIST}" key
+    return getVariance(keyOf(key));
+  }
+
+  // get sum of values in a vector - must be bool, double or, int
+  inline double getSum(Key key) {
+    auto &column = numericColumn(key, "getSum");
     double returnValue = 0;
-    if (typeOfKey == BOOL || typeOfKey == BOOLSOLO) {
-      for (auto e : boolData[key]) {
-        returnValue += (double)e;
-      }
-      // if (boolData[key].size() > 1) {
-      //	returnValue /= boolData[key].size();
-      //} // else vector is  size 1, no div needed or vector is empty,
-      //returnValue will be 0
-    } else if (typeOfKey == DOUBLE || typeOfKey == DOUBLESOLO) {
-      for (auto e : doubleData[key]) {
-        returnValue += (double)e;
-      }
-      // if (doubleData[key].size() > 1) {
-      //	returnValue /= doubleData[key].size();
-      //} // else vector is  size 1, no div needed or vector is empty,
-      //returnValue will be 0
-    } else if (typeOfKey == INT || typeOfKey == INTSOLO) {
-      for (auto e : intData[key]) {
-        returnValue += (double)e;
-      }
-      // if (intData[key].size() > 1) {
-      //	returnValue /= intData[key].size();
-      //} // else vector is  size 1, no div needed or vector is empty,
-      //returnValue will be 0
-    } else if (typeOfKey == STRING || typeOfKey == STRINGSOLO) {
-      std::cout << "  in DataMap::getAverage attempt to use with vector of type "
-              "string associated key \""
-           << key << "\".\n  Cannot average strings!\n  Exiting." << std::endl;
-      exit(1);
-    } else if (typeOfKey == NONE) {
-      std::cout << "  in DataMap::getAverage attempt to get average from "
-              "nonexistent key \""
-           << key << "\".\n  Exiting." << std::endl;
-      exit(1);
-    }
+    forEachNumber(column, [&returnValue](double e) { returnValue += e; });
     return returnValue;
   }
+  inline double
+  getSum(std::string key) { // not ref, we may need to change to a "{LIST}" key
+    return getSum(keyOf(key));
+  }
 
   // Clear a field in a DataMap
-  inline void clear(const std::string &key) {
-    dataMapType typeOfKey = findKeyInData(key);
-    if (typeOfKey != NONE) {
-      if (typeOfKey == BOOL || typeOfKey == BOOLSOLO) { // data is bool
-        boolData.erase(key);
-      } else if (typeOfKey == DOUBLE ||
-                 typeOfKey == DOUBLESOLO) { // data is double
-        doubleData.erase(key);
-      } else if (typeOfKey == INT || typeOfKey == INTSOLO) { // data is int
-        intData.erase(key);
-      } else if (typeOfKey == STRING ||
-                 typeOfKey == STRINGSOLO) { // data is string
-        stringData.erase(key);
+  inline void clear(Key key) {
+    Column *column = findColumn(key);
+    if (column != nullptr) {
+      auto type = listType(column->type);
+      if (type == BOOL) { // data is bool
+        eraseValues<bool>(*column);
+      } else if (type == DOUBLE) { // data is double
+        eraseValues<double>(*column);
+      } else if (type == INT) { // data is int
+        eraseValues<int>(*column);
+      } else { // data is string
+        eraseValues<std::string>(*column);
       }
-      inUse.erase(key);
+      columns.erase(columns.begin() + (column - columns.data()));
     }
   }
+  inline void clear(const std::string &key) { clear(keyOf(key)); }
 
   // Clear all data in a DataMap
   inline void clearMap() {
-    boolData.clear();
-    doubleData.clear();
-    intData.clear();
-    stringData.clear();
-    inUse.clear();
+    columns.clear();
+    boolValues.clear();
+    doubleValues.clear();
+    intValues.clear();
+    stringValues.clear();
   }
 
+  // write or read all keys, values and output behaviors
+  void saveCheckpoint(Checkpoint::Writer &checkpoint);
+  void loadCheckpoint(Checkpoint::Reader &checkpoint);
+
   inline bool
   fieldExists(const std::string &key) { // return true if a data map contains "key"
     return (findKeyInData(key) > 0);
@@ -808,24 +733,22 @@ public:
   inline std::vector<std::string> getColumnNames() {
     std::vector<std::string> columnNames;
 
-    for (auto element : inUse) {
-      //if (outputBehavior.find(element.first) == outputBehavior.end()) {
-      //  // this element has no defined output behavior, so it will be LIST
-      //  // (default) or FIRST (if it's a solo value)
-      //  if (element.second == BOOLSOLO || element.second == DOUBLESOLO ||
-      //      element.second == INTSOLO || element.second == STRINGSOLO) {
-      //    columnNames.push_back(element.first);
-      //  } else {
-      //    columnNames.push_back(element.first + "_LIST");
-      //  }
-      //} else { // there is an output behavior defined
-		 {
-        auto OB = outputBehavior[element.first];
+    std::vector<const Column *> byName;
+    for (auto const &column : columns) {
+      byName.push_back(&column);
+    }
+    std::sort(byName.begin(), byName.end(),
+              [](const Column *a, const Column *b) {
+                return *a->key.name < *b->key.name;
+              });
+    for (auto column : byName) {
+        auto OB = column->outputBehavior;
+        auto const &name = *column->key.name;
         if (OB & AVE) {
-          columnNames.push_back(element.first + "_AVE");
+          columnNames.push_back(name + "_AVE");
         }
         if (OB & FIRST) {
-          columnNames.push_back(element.first);
+          columnNames.push_back(name);
         }
         if (OB & SUM) {
           std::cout << "  WARNING OUTPUT METHOD SUM IS HAS YET TO BE WRITTEN!"
@@ -840,54 +763,32 @@ public:
                << std::endl;
         }
         if (OB & LIST) {
-          columnNames.push_back(element.first + "_LIST");
+          columnNames.push_back(name + "_LIST");
         }
 		  // if (OB & NO_OUTPUT) do nothing...
-      }
     }
     return columnNames;
   }
-  //	/*
-  //	 * takes a vector of string with key value pairs. Calls set for each
-  //pair.
-  //	 */
-  //	void SetMany(vector<string> dataPairs);
 
   inline DataMap remakeDataMapWithPrefix(std::string prefix, bool stringify = 0) {
     DataMap copyDataMap;
-    dataMapType entryType;
-    if (!stringify) {
-      for (auto key : getKeys()) {
-        entryType = findKeyInData(key);
-        if (entryType == BOOL || entryType == BOOLSOLO) {
-          copyDataMap.set(prefix + "_" + key, getBoolVector(key));
-        }
-        if (entryType == STRING || entryType == STRINGSOLO) {
-          copyDataMap.set(prefix + "_" + key, getStringVector(key));
-        }
-        if (entryType == INT || entryType == INTSOLO) {
-          copyDataMap.set(prefix + "_" + key, getIntVector(key));
-        }
-        if (entryType == DOUBLE || entryType == DOUBLESOLO) {
-          copyDataMap.set(prefix + "_" + key, getDoubleVector(key));
-        }
-        copyDataMap.setOutputBehavior(prefix + "_" + key, outputBehavior[key]);
+    for (auto key : getKeys()) {
+      auto entryType = listType(findKeyInData(key));
+      auto newKey = keyOf(prefix + "_" + key);
+      if (entryType == BOOL) {
+        copyDataMap.set(newKey, getBoolVector(key));
       }
-    } else {
-      for (auto key : getKeys()) {
-        entryType = findKeyInData(key);
-        if (entryType == BOOL || entryType == BOOLSOLO) {
-          copyDataMap.set(prefix + "_" + key, getBoolVector(key));
-        }
-        if (entryType == STRING || entryType == STRINGSOLO) {
-          copyDataMap.set(prefix + "_" + key, getStringVector(key));
-        }
-        if (entryType == INT || entryType == INTSOLO) {
-          copyDataMap.set(prefix + "_" + key, getIntVector(key));
-        }
-        if (entryType == DOUBLE || entryType == DOUBLESOLO) {
-          copyDataMap.set(prefix + "_" + key, getDoubleVector(key));
-        }
+      if (entryType == STRING) {
+        copyDataMap.set(newKey, getStringVector(key));
+      }
+      if (entryType == INT) {
+        copyDataMap.set(newKey, getIntVector(key));
+      }
+      if (entryType == DOUBLE) {
+        copyDataMap.set(newKey, getDoubleVector(key));
+      }
+      if (!stringify) {
+        copyDataMap.setOutputBehavior(newKey, getOutputBehavior(key));
       }
     }
     return copyDataMap;
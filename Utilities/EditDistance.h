@@ -0,0 +1,313 @@
+//  MABE is a product of The Hintze Lab @ MSU
+//     for general research information:
+//         hintzelab.msu.edu
+//     for MABE documentation:
+//         github.com/Hintzelab/MABE/wiki
+//
+//  Copyright (c) 2015 Michigan State University. All rights reserved.
+//     to view the full license, visit:
+//         github.com/Hintzelab/MABE/wiki/License
+
+// This file provides edit distances between vectors of symbols (usually rank
+// vectors), for NKWorld and the standalone analysis tool
+// (analysis/cpp_analysis). It only depends on the standard library.
+//
+// Metrics (EditDistanceMetric, as used by outputEditDistanceMetric):
+//   kLevenshtein         substitutions, insertions and deletions, computed
+//                        64 rows at a time with bit vectors (Myers 1999,
+//                        Hyyro 2001), O(n * m / 64) time and O(m) space
+//   kDamerau_Levenshtein Levenshtein plus transpositions of any two symbols,
+//                        O(n * m) time and space
+//   kIndel               insertions and deletions only, n + m - 2 * LCS. If
+//                        one vector is a permutation of the other and either
+//                        is sorted or free of repeats (e.g. rank vectors) the
+//                        LCS is a longest increasing subsequence,
+//                        O(n log n); otherwise bit vectors, O(n * m / 64)
+//   kLevenshteinRows     same value as kLevenshtein, one row at a time in
+//                        O(n * m) time and O(m) space (for checking)
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+enum EditDistanceMetric {
+  kLevenshtein = 0,
+  kDamerau_Levenshtein = 1,
+  kIndel = 2,
+  kLevenshteinRows = 3
+};
+
+namespace EditDistanceKernels {
+
+// Match masks of pattern, one set of words per distinct symbol: bit i of
+// symbol s is set if pattern[i] == s
+class PatternMasks {
+public:
+  std::vector<size_t> symbols; // distinct symbols in pattern, sorted
+  std::vector<uint64_t> masks; // words per symbol, in symbols order
+  size_t words;
+  std::vector<uint64_t> noMatch; // mask of a symbol not in pattern
+
+  explicit PatternMasks(const std::vector<size_t> &pattern) {
+    words = (pattern.size() + 63) / 64;
+    symbols = pattern;
+    std::sort(symbols.begin(), symbols.end());
+    symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+    masks.assign(symbols.size() * words, 0);
+    noMatch.assign(words, 0);
+    for (size_t i = 0; i < pattern.size(); i++) {
+      size_t s = std::lower_bound(symbols.begin(), symbols.end(), pattern[i]) -
+                 symbols.begin();
+      masks[s * words + i / 64] |= (uint64_t)1 << (i % 64);
+    }
+  }
+
+  const uint64_t *get(size_t symbol) const {
+    auto found = std::lower_bound(symbols.begin(), symbols.end(), symbol);
+    if (found == symbols.end() || *found != symbol) {
+      return noMatch.data();
+    }
+    return &masks[(found - symbols.begin()) * words];
+  }
+};
+
+// Levenshtein distance, one column of 64 bit blocks per symbol of text.
+// Each block holds the vertical differences (+1 / -1) of 64 rows, and passes
+// the horizontal difference of its last row down to the next block.
+inline size_t levenshteinBits(const std::vector<size_t> &pattern,
+                              const std::vector<size_t> &text) {
+  if (pattern.empty()) {
+    return text.size();
+  }
+  PatternMasks peq(pattern);
+  size_t words = peq.words;
+  std::vector<uint64_t> Pv(words, ~(uint64_t)0);
+  std::vector<uint64_t> Mv(words, 0);
+  uint64_t lastBit = (uint64_t)1 << ((pattern.size() - 1) % 64);
+  size_t score = pattern.size();
+  for (size_t symbol : text) {
+    const uint64_t *Eq = peq.get(symbol);
+    int hin = 1; // the top row is 0, 1, 2, ...
+    for (size_t w = 0; w < words; w++) {
+      uint64_t pv = Pv[w];
+      uint64_t mv = Mv[w];
+      uint64_t eq = Eq[w];
+      uint64_t Xv = eq | mv;
+      if (hin < 0) {
+        eq |= 1;
+      }
+      uint64_t Xh = (((eq & pv) + pv) ^ pv) | eq;
+      uint64_t Ph = mv | ~(Xh | pv);
+      uint64_t Mh = pv & Xh;
+      uint64_t highBit = (w == words - 1) ? lastBit : (uint64_t)1 << 63;
+      int hout = (Ph & highBit) ? 1 : ((Mh & highBit) ? -1 : 0);
+      Ph <<= 1;
+      Mh <<= 1;
+      if (hin < 0) {
+        Mh |= 1;
+      } else if (hin > 0) {
+        Ph |= 1;
+      }
+      Pv[w] = Mh | ~(Xv | Ph);
+      Mv[w] = Ph & Xv;
+      hin = hout;
+    }
+    score += hin;
+  }
+  return score;
+}
+
+// Levenshtein distance keeping only the previous row of the table
+inline size_t levenshteinRows(const std::vector<size_t> &vec_a,
+                              const std::vector<size_t> &vec_b) {
+  std::vector<size_t> row(vec_b.size() + 1);
+  for (size_t j = 0; j <= vec_b.size(); j++) {
+    row[j] = j;
+  }
+  for (size_t i = 1; i <= vec_a.size(); i++) {
+    size_t diagonal = row[0]; // row i - 1, column j - 1
+    row[0] = i;
+    for (size_t j = 1; j <= vec_b.size(); j++) {
+      size_t above = row[j];
+      size_t sub_cost = (vec_a[i - 1] == vec_b[j - 1]) ? 0 : 1;
+      row[j] = std::min({row[j - 1] + 1, above + 1, diagonal + sub_cost});
+      diagonal = above;
+    }
+  }
+  return row[vec_b.size()];
+}
+
+// length of the longest common subsequence, with bit vectors (Allison & Dix
+// 1986, Hyyro 2004): zero bits of V mark pattern positions used by the LCS
+inline size_t lcsBits(const std::vector<size_t> &pattern,
+                      const std::vector<size_t> &text) {
+  if (pattern.empty()) {
+    return 0;
+  }
+  PatternMasks peq(pattern);
+  size_t words = peq.words;
+  std::vector<uint64_t> V(words, ~(uint64_t)0);
+  for (size_t symbol : text) {
+    const uint64_t *M = peq.get(symbol);
+    uint64_t carry = 0;
+    for (size_t w = 0; w < words; w++) {
+      uint64_t U = V[w] & M[w];
+      uint64_t sum = V[w] + U;
+      uint64_t carryOut = sum < V[w];
+      sum += carry;
+      carryOut |= sum < carry;
+      V[w] = sum | (V[w] - U);
+      carry = carryOut;
+    }
+  }
+  size_t ones = 0;
+  for (size_t i = 0; i < pattern.size(); i++) {
+    ones += (V[i / 64] >> (i % 64)) & 1;
+  }
+  return pattern.size() - ones;
+}
+
+// length of the longest common subsequence when vec_b is a permutation of
+// vec_a and vec_a is sorted or has no repeated symbols, -1 otherwise. Listing
+// every symbol of vec_b by the position of the same symbol in vec_a (equal
+// symbols matched up in order) then turns common subsequences into
+// increasing subsequences.
+inline long long lcsPermutation(const std::vector<size_t> &vec_a,
+                                const std::vector<size_t> &vec_b) {
+  if (vec_a.size() != vec_b.size()) {
+    return -1;
+  }
+  size_t n = vec_a.size();
+  std::vector<size_t> order_a(n), order_b(n);
+  for (size_t i = 0; i < n; i++) {
+    order_a[i] = i;
+    order_b[i] = i;
+  }
+  std::stable_sort(order_a.begin(), order_a.end(),
+                   [&vec_a](size_t x, size_t y) { return vec_a[x] < vec_a[y]; });
+  std::stable_sort(order_b.begin(), order_b.end(),
+                   [&vec_b](size_t x, size_t y) { return vec_b[x] < vec_b[y]; });
+  if (!std::is_sorted(vec_a.begin(), vec_a.end())) {
+    for (size_t i = 1; i < n; i++) {
+      if (vec_a[order_a[i]] == vec_a[order_a[i - 1]]) {
+        return -1; // repeated symbols out of order can match up crosswise
+      }
+    }
+  }
+  std::vector<size_t> position(n);
+  for (size_t i = 0; i < n; i++) {
+    if (vec_a[order_a[i]] != vec_b[order_b[i]]) {
+      return -1;
+    }
+    position[order_b[i]] = order_a[i];
+  }
+  std::vector<size_t> tails; // smallest tail of an increasing run of each length
+  for (size_t p : position) {
+    auto slot = std::lower_bound(tails.begin(), tails.end(), p);
+    if (slot == tails.end()) {
+      tails.push_back(p);
+    } else {
+      *slot = p;
+    }
+  }
+  return tails.size();
+}
+
+} // namespace EditDistanceKernels
+
+// Levenshtein
+// Defined at https://en.wikipedia.org/wiki/Levenshtein_distance
+inline double EditDistance_L(const std::vector<size_t> &vec_a,
+                             const std::vector<size_t> &vec_b) {
+  return EditDistanceKernels::levenshteinBits(vec_a, vec_b);
+}
+
+// Damerau-Levenshtein
+// From psuedocode at https://en.wikipedia.org/wiki/Damerau%E2%80%93Levenshtein_distance
+// Also useful for understanding: https://www.lemoda.net/text-fuzzy/damerau-levenshtein/index.html
+inline double EditDistance_DL(const std::vector<size_t> &vec_a,
+                              const std::vector<size_t> &vec_b) {
+  size_t rows = vec_a.size() + 2;
+  size_t cols = vec_b.size() + 2;
+  // last row (+2) each symbol was seen in vec_a, symbols are looked up by
+  // their place among the symbols of vec_b
+  std::vector<size_t> symbols = vec_b;
+  std::sort(symbols.begin(), symbols.end());
+  symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+  auto symbolIndex = [&symbols](size_t symbol) {
+    return std::lower_bound(symbols.begin(), symbols.end(), symbol) -
+           symbols.begin();
+  };
+  std::vector<size_t> da(symbols.size(), 1);
+  std::vector<size_t> matrix(rows * cols, 0);
+  size_t max_dist = vec_a.size() + vec_b.size();
+  for (size_t i = 0; i < rows; i++) {
+    matrix[i * cols] = max_dist;
+    matrix[i * cols + 1] = i - 1;
+  }
+  for (size_t j = 1; j < cols; j++) {
+    matrix[j] = max_dist;
+    matrix[cols + j] = j - 1;
+  }
+  for (size_t i = 2; i < rows; i++) {
+    size_t db = 1;
+    for (size_t j = 2; j < cols; j++) {
+      size_t k = da[symbolIndex(vec_b[j - 2])]; // last row with vec_b's symbol
+      size_t l = db;
+      size_t cost = 1;
+      if (vec_a[i - 2] == vec_b[j - 2]) {
+        cost = 0;
+        db = j;
+      }
+      matrix[i * cols + j] = std::min({
+          matrix[(i - 1) * cols + j - 1] + cost, // Substitution
+          matrix[i * cols + j - 1] + 1,          // Insertion
+          matrix[(i - 1) * cols + j] + 1,        // Deletion
+          matrix[(k - 1) * cols + l - 1] + (i - k - 1) + 1 +
+              (j - l - 1) // Transposition
+      });
+    }
+    size_t symbol = symbolIndex(vec_a[i - 2]);
+    if (symbol < symbols.size() && symbols[symbol] == vec_a[i - 2]) {
+      da[symbol] = i;
+    }
+  }
+  return matrix[rows * cols - 1];
+}
+
+// Insertions and deletions only
+inline double EditDistance_Indel(const std::vector<size_t> &vec_a,
+                                 const std::vector<size_t> &vec_b) {
+  long long lcs = EditDistanceKernels::lcsPermutation(vec_a, vec_b);
+  if (lcs < 0) {
+    lcs = EditDistanceKernels::lcsPermutation(vec_b, vec_a);
+  }
+  if (lcs < 0) {
+    lcs = EditDistanceKernels::lcsBits(vec_a, vec_b);
+  }
+  return vec_a.size() + vec_b.size() - 2 * lcs;
+}
+
+// General edit distance function that will direct you to the specified metric
+inline double EditDistance(const std::vector<size_t> &vec_a,
+                           const std::vector<size_t> &vec_b,
+                           EditDistanceMetric metric) {
+  switch (metric) {
+  case kLevenshtein:
+    return EditDistance_L(vec_a, vec_b);
+  case kDamerau_Levenshtein:
+    return EditDistance_DL(vec_a, vec_b);
+  case kIndel:
+    return EditDistance_Indel(vec_a, vec_b);
+  case kLevenshteinRows:
+    return EditDistanceKernels::levenshteinRows(vec_a, vec_b);
+  default:
+    std::cerr << "Error! Unknown edit distance metric!" << std::endl;
+    exit(-1);
+  }
+  return 0;
+}
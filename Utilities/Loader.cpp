@@ -4,9 +4,12 @@
 #include "Loader.h"
 #include "Filesystem.h"
 #include "CSV.h"
+#include "BinarySnapshot.h"
 
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <numeric>
 #include <random>
@@ -520,6 +523,9 @@ std::vector<std::string> Loader::expandFiles(const std::string &file) {
 
 std::pair<long, long> Loader::generatePopulation(const std::string &file_name) {
 
+  if (BinarySnapshot::isBinarySnapshot(file_name)) {
+    return generateBinaryPopulation(file_name);
+  }
   // store organism file in memory-mapped CSV
   CSV org_file_data = CSV(file_name);
   // setup the range of indices needed to identify all organisms from this file
@@ -559,6 +565,58 @@ std::pair<long, long> Loader::generatePopulation(const std::string &file_name) {
   return file_contents_pair;
 } // end Loader::generatePopulation
 
+std::pair<long, long> Loader::generateBinaryPopulation(const std::string &file_name) {
+
+  BinarySnapshot::Reader reader;
+  std::string error;
+  if (!reader.open(file_name, error)) {
+    std::cout << " error: could not load " << file_name << ": " << error
+              << std::endl;
+    exit(1);
+  }
+  auto const &header = reader.getHeader();
+  std::pair<long,long> file_contents_pair = std::make_pair(long(all_organism_infos.size()), long(header.populationSize));
+
+  // the attributes are the same strings a csv organisms file (merged with its
+  // _data file) would have produced, except for the genome's sites, which are
+  // kept as numbers (see getSiteValues)
+  std::string length_key = "GENOME_" + header.genomeName + "_genomeLength";
+  BinarySnapshot::Record record;
+  std::ostringstream value;
+  value << std::setprecision(std::numeric_limits<double>::max_digits10);
+  while (reader.read(record, error)) {
+    OrganismInfo org_info;
+    std::string id = std::to_string(record.ID);
+    org_info.orig_ID = record.ID;
+    org_info.from_file = file_name;
+    auto &sites = org_info.sites_map[header.genomeName];
+    sites.resize(record.siteCount);
+    for (size_t i = 0; i < record.siteCount; i++) {
+      sites[i] = record.site(i, header.bitsPerSite);
+    }
+    org_info.attributes_map[length_key] = std::to_string(record.siteCount);
+    org_info.attributes_map["ID"] = id;
+    for (size_t c = 0; c < header.columns.size(); c++) {
+      value.str("");
+      value << record.values[c];
+      org_info.attributes_map[header.columns[c]] = value.str();
+    }
+    org_info.attributes_map.insert(std::make_pair("loadedFrom.ID",id));
+    org_info.attributes_map.insert(std::make_pair("loadedFrom.File",file_name));
+    if (org_info.attributes_map.find("update") != org_info.attributes_map.end()) { 
+      org_info.attributes_map.insert(std::make_pair("loadedFrom.Update",org_info.attributes_map["update"]));
+    }
+    all_organism_infos.push_back(std::move(org_info));
+  }
+  if (!error.empty()) {
+    std::cout << " error: could not load " << file_name << ": " << error
+              << std::endl;
+    exit(1);
+  }
+
+  return file_contents_pair;
+} // end Loader::generateBinaryPopulation
+
 
 void Loader::printOrganism(long i) {
 
@@ -9,8 +9,10 @@
 #include <vector>
 #include <set>
 #include <regex>
+#include <cstdint>
 
 typedef std::unordered_map<std::string,std::string> OrgAttributesMap;
+typedef std::unordered_map<std::string,std::vector<uint32_t>> OrgSitesMap; // genome name -> site values
 typedef long OrgID;
 
 class Loader {
@@ -18,6 +20,7 @@ public:
 private:
   struct OrganismInfo { // all of the organisms info pulled from organisms_files and data_files
     OrgAttributesMap attributes_map;
+    OrgSitesMap sites_map; // genomes read as numbers (binary snapshots), not in attributes_map
     // long ID;	// not used, since ID is known from position in all_organism_infos
     std::string from_file;  // name of organism file this org was pulled from
     int orig_ID; // ID in the original file
@@ -40,6 +43,7 @@ private:
   
   std::vector<std::string> expandFiles(const std::string &);// for user inputted wildcards
   std::pair<long, long> generatePopulation(const std::string &);
+  std::pair<long, long> generateBinaryPopulation(const std::string &); // for files written with ARCHIVIST_DEFAULT-snapshotOrganismsFormat = binary
 	std::string findAndGenerateAllFiles(std::string /*all_lines*/);
   // read MABE generated files and constructs organsims 
   // redundant function from MABE - should be cleaned
@@ -73,4 +77,8 @@ private:
 
 public:
   std::vector<std::pair<OrgID, OrgAttributesMap>> loadPopulation(const std::string &);
+  // site values of the genomes of a loaded organism (ID as given by
+  // loadPopulation) that were read as numbers; set them with
+  // AbstractGenome::setSiteValues instead of deserializing
+  const OrgSitesMap &getSiteValues(OrgID ID) const { return all_organism_infos.at(ID).sites_map; }
 };
@@ -1,5 +1,7 @@
 #include "MTree.h"
 
+#include <algorithm>
+
 std::vector<double> Abstract_MTree::eval(DataMap &dataMap) {
   std::vector<std::vector<double>> placeholder = {};
   return eval(dataMap, nullptr, placeholder);
@@ -252,3 +254,241 @@ std::string IF_MTree::getFormula() {
 }
 
 std::vector<int> IF_MTree::numBranches() { return requiredBranches; }
+
+CompiledMTree::CompiledMTree(std::shared_ptr<Abstract_MTree> _tree)
+    : tree(_tree) {
+  compiled = tree != nullptr && compile(tree, 0);
+  if (!compiled) {
+    program.clear();
+    stackDepth = 0;
+  }
+}
+
+// append the instructions for node (whose value will be stack entry depth)
+// to program. Returns false if node can not be compiled.
+bool CompiledMTree::compile(std::shared_ptr<Abstract_MTree> node, int depth) {
+  auto const type = node->type();
+  auto const numBranches = (int)node->branches.size();
+  Instruction instruction = {Op::CONST, 0, 0.0, DataMap::Key()};
+  if (type == "CONST") {
+    instruction.value = std::dynamic_pointer_cast<CONST_MTree>(node)->value;
+  } else if (type == "DM_AVE") {
+    instruction.op = Op::DM_AVE;
+    instruction.key = DataMap::keyOf(
+        std::dynamic_pointer_cast<fromDataMapAve_MTree>(node)->key);
+  } else if (type == "DM_SUM") {
+    instruction.op = Op::DM_SUM;
+    instruction.key = DataMap::keyOf(
+        std::dynamic_pointer_cast<fromDataMapSum_MTree>(node)->key);
+  } else if (type == "UPDATE") {
+    instruction.op = Op::UPDATE;
+  } else if (type == "MANY") { // only the first value is used
+    return numBranches > 0 && compile(node->branches[0], depth);
+  } else if (type == "SUM" || type == "MULT") {
+    if (numBranches == 0) { // the sum or product of nothing
+      instruction.value = (type == "SUM") ? 0 : 1;
+    } else {
+      instruction.op = (type == "SUM") ? Op::SUM : Op::MULT;
+      instruction.operands = numBranches;
+    }
+  } else if (type == "MIN" || type == "MAX") {
+    instruction.op = (type == "MIN") ? Op::MIN : Op::MAX;
+    instruction.operands = numBranches;
+  } else if (type == "SUBTRACT" || type == "DIVIDE" || type == "POW" ||
+             type == "MOD") {
+    instruction.op = (type == "SUBTRACT") ? Op::SUBTRACT
+                     : (type == "DIVIDE") ? Op::DIVIDE
+                     : (type == "POW")    ? Op::POW
+                                          : Op::MOD;
+    instruction.operands = 2;
+  } else if (type == "SIN" || type == "COS" || type == "ABS") {
+    instruction.op = (type == "SIN") ? Op::SIN
+                     : (type == "COS") ? Op::COS
+                                       : Op::ABS;
+    instruction.operands = 1;
+  } else if (type == "IF") {
+    instruction.op = Op::IF;
+    instruction.operands = 3;
+  } else if (type == "REMAP") {
+    instruction.op = Op::REMAP;
+    instruction.operands = std::min(numBranches, 5);
+  } else if (type == "SIGMOID") {
+    instruction.op = Op::SIGMOID;
+    instruction.operands = (numBranches > 2) ? 4 : 2;
+  } else { // RANDOM, VECT or unknown
+    return false;
+  }
+  if (instruction.operands > numBranches ||
+      (instruction.operands == 0 && instruction.op != Op::CONST &&
+       instruction.op != Op::DM_AVE && instruction.op != Op::DM_SUM &&
+       instruction.op != Op::UPDATE)) {
+    return false; // not enough branches to evaluate
+  }
+  for (int i = 0; i < instruction.operands; i++) {
+    if (!compile(node->branches[i], depth + i)) {
+      return false;
+    }
+  }
+  stackDepth = std::max(stackDepth, depth + std::max(instruction.operands, 1));
+  program.push_back(instruction);
+  return true;
+}
+
+double CompiledMTree::eval(DataMap &dataMap,
+                           std::shared_ptr<ParametersTable> PT) {
+  if (!compiled) {
+    return tree->eval(dataMap, PT)[0];
+  }
+  oneMap.assign(1, &dataMap);
+  evalAll(oneMap, PT, oneValue);
+  return oneValue[0];
+}
+
+void CompiledMTree::evalAll(const std::vector<DataMap *> &dataMaps,
+                            std::shared_ptr<ParametersTable> PT,
+                            std::vector<double> &values) {
+  auto const n = dataMaps.size();
+  values.resize(n);
+  if (!compiled) {
+    for (size_t i = 0; i < n; i++) {
+      values[i] = tree->eval(*dataMaps[i], PT)[0];
+    }
+    return;
+  }
+  if (n == 0) {
+    return;
+  }
+  // the stack holds stackDepth rows of n values, one value per DataMap. Each
+  // instruction replaces its operands (the top rows) with its result.
+  stack.resize(stackDepth * n);
+  int top = 0; // rows in use
+  for (auto const &instruction : program) {
+    auto const first = top - instruction.operands;
+    double *out = &stack[first * n]; // first operand and result
+    auto row = [&](int operand) { return &stack[(first + operand) * n]; };
+    switch (instruction.op) {
+    case Op::CONST:
+      std::fill(out, out + n, instruction.value);
+      break;
+    case Op::DM_AVE:
+      for (size_t i = 0; i < n; i++) {
+        out[i] = dataMaps[i]->getAverage(instruction.key);
+      }
+      break;
+    case Op::DM_SUM:
+      for (size_t i = 0; i < n; i++) {
+        out[i] = dataMaps[i]->getSum(instruction.key);
+      }
+      break;
+    case Op::UPDATE:
+      std::fill(out, out + n, (double)Global::update);
+      break;
+    case Op::SUM:
+      for (size_t i = 0; i < n; i++) {
+        out[i] = 0.0 + out[i]; // as SUM_MTree, which starts from 0
+      }
+      for (int b = 1; b < instruction.operands; b++) {
+        auto in = row(b);
+        for (size_t i = 0; i < n; i++) {
+          out[i] += in[i];
+        }
+      }
+      break;
+    case Op::MULT:
+      for (int b = 1; b < instruction.operands; b++) {
+        auto in = row(b);
+        for (size_t i = 0; i < n; i++) {
+          out[i] *= in[i];
+        }
+      }
+      break;
+    case Op::SUBTRACT: {
+      auto in = row(1);
+      for (size_t i = 0; i < n; i++) {
+        out[i] -= in[i];
+      }
+    } break;
+    case Op::DIVIDE: {
+      auto in = row(1);
+      for (size_t i = 0; i < n; i++) {
+        out[i] = (in[i] == 0) ? 0 : out[i] / in[i];
+      }
+    } break;
+    case Op::POW: {
+      auto in = row(1);
+      for (size_t i = 0; i < n; i++) {
+        out[i] = pow(out[i], in[i]);
+      }
+    } break;
+    case Op::SIN:
+      for (size_t i = 0; i < n; i++) {
+        out[i] = sin(out[i]);
+      }
+      break;
+    case Op::COS:
+      for (size_t i = 0; i < n; i++) {
+        out[i] = cos(out[i]);
+      }
+      break;
+    case Op::ABS:
+      for (size_t i = 0; i < n; i++) {
+        out[i] = std::abs(out[i]);
+      }
+      break;
+    case Op::MOD: {
+      auto in = row(1);
+      for (size_t i = 0; i < n; i++) {
+        int divisor = ((int)in[i] == 0) ? 1 : (int)in[i];
+        out[i] = (int)out[i] % divisor;
+      }
+    } break;
+    case Op::IF: {
+      auto ifTrue = row(1);
+      auto ifFalse = row(2);
+      for (size_t i = 0; i < n; i++) {
+        out[i] = (out[i] > 0) ? ifTrue[i] : ifFalse[i];
+      }
+    } break;
+    case Op::MIN:
+    case Op::MAX:
+      for (int b = 1; b < instruction.operands; b++) {
+        auto in = row(b);
+        for (size_t i = 0; i < n; i++) {
+          out[i] = (instruction.op == Op::MIN) ? std::min(out[i], in[i])
+                                               : std::max(out[i], in[i]);
+        }
+      }
+      break;
+    case Op::REMAP: {
+      auto const operands = instruction.operands;
+      for (size_t i = 0; i < n; i++) {
+        auto v = out[i];
+        auto oldMin = (operands > 2) ? row(1)[i] : 0;
+        auto oldMax = (operands > 2) ? row(2)[i] : 1;
+        auto newMin = (operands > 4) ? row(3)[i] : 0;
+        auto newMax = (operands > 4) ? row(4)[i] : 1;
+        out[i] = ((std::max(std::min(v, oldMax), oldMin) - oldMin) *
+                  (1 / (oldMax - oldMin)) * (newMax - newMin)) +
+                 newMin;
+      }
+    } break;
+    case Op::SIGMOID: {
+      auto e = row(1);
+      for (size_t i = 0; i < n; i++) {
+        auto v = out[i];
+        if (instruction.operands > 2) {
+          auto oldMin = row(2)[i];
+          auto oldMax = row(3)[i];
+          v = ((std::max(std::min(v, oldMax), oldMin)) - oldMin) *
+              (1 / (oldMax - oldMin));
+        } else {
+          v = std::max(std::min(v, 1.0), 0.0);
+        }
+        out[i] = (v <= .5) ? pow(v * 2, e[i]) / 2 : 1 - pow((1 - v) * 2, e[i]) / 2;
+      }
+    } break;
+    }
+    top = first + 1;
+  }
+  std::copy(stack.begin(), stack.begin() + n, values.begin());
+}
@@ -1502,3 +1502,64 @@ stringToMTree(std::string formula) {
 	exit(1);
 }
 
+
+// A CompiledMTree is an MTree flattened into a list of instructions (in
+// postfix order) with its DataMap keys looked up once. evalAll runs each
+// instruction over a whole population at a time, which is much cheaper than
+// calling eval on the tree for each organism.
+// Trees that use RANDOM or VECT (or an op with too few branches to evaluate)
+// are not compiled; for these eval and evalAll call the tree for each
+// DataMap in order, so the results (and random numbers drawn) are the same.
+// Note: a compiled IF or DIVIDE evaluates all of its branches, not only the
+// one the tree would have used.
+class CompiledMTree {
+public:
+	CompiledMTree() = default;
+	CompiledMTree(std::shared_ptr<Abstract_MTree> _tree);
+
+	// false if the tree is evaluated node by node (see above)
+	bool isCompiled() const { return compiled; }
+
+	// value of the formula for one DataMap (first value if it returns many)
+	double eval(DataMap &dataMap, std::shared_ptr<ParametersTable> PT);
+
+	// values[i] = value of the formula for dataMaps[i]
+	void evalAll(const std::vector<DataMap *> &dataMaps,
+		std::shared_ptr<ParametersTable> PT, std::vector<double> &values);
+
+	// values[i] = value of the formula for population[i]->dataMap
+	template <class Population>
+	void evalAll(const Population &population,
+		std::shared_ptr<ParametersTable> PT, std::vector<double> &values) {
+		populationMaps.clear();
+		for (auto const &org : population) {
+			populationMaps.push_back(&org->dataMap);
+		}
+		evalAll(populationMaps, PT, values);
+	}
+
+private:
+	enum class Op {
+		CONST, DM_AVE, DM_SUM, UPDATE, SUM, MULT, SUBTRACT, DIVIDE, POW, SIN,
+		COS, ABS, MOD, IF, MIN, MAX, REMAP, SIGMOID
+	};
+	struct Instruction {
+		Op op;
+		int operands; // number of stack entries used
+		double value; // CONST
+		DataMap::Key key; // DM_AVE, DM_SUM
+	};
+
+	std::shared_ptr<Abstract_MTree> tree;
+	bool compiled = false;
+	std::vector<Instruction> program;
+	int stackDepth = 0;
+
+	// scratch space reused between calls
+	std::vector<double> stack;
+	std::vector<DataMap *> populationMaps;
+	std::vector<DataMap *> oneMap;
+	std::vector<double> oneValue;
+
+	bool compile(std::shared_ptr<Abstract_MTree> node, int depth);
+};
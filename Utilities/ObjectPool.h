@@ -0,0 +1,173 @@
+//  MABE is a product of The Hintze Lab @ MSU
+//     for general research information:
+//         hintzelab.msu.edu
+//     for MABE documentation:
+//         github.com/Hintzelab/MABE/wiki
+//
+//  Copyright (c) 2015 Michigan State University. All rights reserved.
+//     to view the full license, visit:
+//         github.com/Hintzelab/MABE/wiki/License
+
+// This file provides pools that keep objects once nothing uses them anymore,
+// so they can be reused (along with the memory they hold, such as vector
+// capacity) instead of being freed while a new one is allocated.
+//
+// ObjectPool<T>::instance().get(fits) returns a kept object for which
+// fits(object) is true, or nullptr; the caller then makes one with
+// adopt(new T(...)). Either way, when the last shared_ptr to the object is
+// dropped, its recycle() is called (it should let go of everything it points
+// to) and the object is kept. A reused object is as recycle() left it, so the
+// caller must set everything that matters. Pools may be used from several
+// threads at once.
+//
+// ObjectPools::endUpdate() is called once per update. It frees kept objects
+// beyond the number the update just ended made and reused, so a pool does
+// not hold on to its peak size after the population shrinks.
+// ObjectPools::record() then adds to a DataMap how many objects each pool
+// made and reused in that update, and how many it is keeping.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Data.h"
+
+class ObjectPools {
+public:
+  class Pool {
+  public:
+    std::string name;
+    std::atomic<long long> made{0};
+    std::atomic<long long> reused{0};
+    long long lastMade = 0; // made and reused in the last update
+    long long lastReused = 0;
+    virtual long long kept() = 0;
+    virtual void trim(long long keep) = 0; // free all but keep kept objects
+  };
+
+  // if false, objects are freed when no longer used (GLOBAL-poolObjects)
+  static bool &enabled() {
+    static bool enabled = true;
+    return enabled;
+  }
+
+  static void add(Pool *pool) {
+    std::lock_guard<std::mutex> lock(registryMutex());
+    pools().push_back(pool);
+  }
+
+  static void endUpdate() {
+    std::lock_guard<std::mutex> lock(registryMutex());
+    for (auto pool : pools()) {
+      pool->lastMade = pool->made.exchange(0);
+      pool->lastReused = pool->reused.exchange(0);
+      pool->trim(pool->lastMade + pool->lastReused);
+    }
+  }
+
+  static void record(DataMap &dataMap) {
+    std::lock_guard<std::mutex> lock(registryMutex());
+    for (auto pool : pools()) {
+      dataMap.set(pool->name + "_made", (int)pool->lastMade);
+      dataMap.set(pool->name + "_reused", (int)pool->lastReused);
+      dataMap.set(pool->name + "_kept", (int)pool->kept());
+    }
+  }
+
+private:
+  static std::vector<Pool *> &pools() {
+    static std::vector<Pool *> pools;
+    return pools;
+  }
+  static std::mutex &registryMutex() {
+    static std::mutex registryMutex;
+    return registryMutex;
+  }
+};
+
+template <class T> class ObjectPool : public ObjectPools::Pool {
+public:
+  // name (used in record()) is taken from the first call. Pools are never
+  // destroyed, so objects dropped during exit can still be returned to them
+  static ObjectPool &instance(const char *name) {
+    static ObjectPool *pool = new ObjectPool(name);
+    return *pool;
+  }
+
+  template <class Fits> std::shared_ptr<T> get(Fits fits) {
+    if (!ObjectPools::enabled()) {
+      return nullptr;
+    }
+    T *object = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(poolMutex);
+      if (freeObjects.empty()) {
+        return nullptr;
+      }
+      object = freeObjects.back();
+      freeObjects.pop_back();
+    }
+    if (!fits(*object)) { // made for other settings
+      delete object;
+      return nullptr;
+    }
+    reused++;
+    return std::shared_ptr<T>(object, Recycle{this});
+  }
+
+  std::shared_ptr<T> adopt(T *object) {
+    made++;
+    if (!ObjectPools::enabled()) {
+      return std::shared_ptr<T>(object);
+    }
+    return std::shared_ptr<T>(object, Recycle{this});
+  }
+
+  virtual long long kept() override {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return (long long)freeObjects.size();
+  }
+
+  virtual void trim(long long keep) override {
+    std::vector<T *> surplus;
+    {
+      std::lock_guard<std::mutex> lock(poolMutex);
+      if ((long long)freeObjects.size() <= keep) {
+        return;
+      }
+      // the most recently kept objects are reused first, so the oldest go
+      auto last = freeObjects.end() - keep;
+      surplus.assign(freeObjects.begin(), last);
+      freeObjects.erase(freeObjects.begin(), last);
+    }
+    for (auto object : surplus) {
+      delete object;
+    }
+  }
+
+private:
+  std::mutex poolMutex;
+  std::vector<T *> freeObjects;
+
+  explicit ObjectPool(const char *name_) {
+    name = name_;
+    ObjectPools::add(this);
+  }
+
+  struct Recycle {
+    ObjectPool *pool;
+    void operator()(T *object) const { pool->put(object); }
+  };
+
+  void put(T *object) {
+    // recycle() may drop the last pointer to other pooled objects (a
+    // parent organism, say), so it is called before taking the lock
+    object->recycle();
+    std::lock_guard<std::mutex> lock(poolMutex);
+    freeObjects.push_back(object);
+  }
+};
@@ -0,0 +1,125 @@
+//  MABE is a product of The Hintze Lab @ MSU
+//     for general research information:
+//         hintzelab.msu.edu
+//     for MABE documentation:
+//         github.com/Hintzelab/MABE/wiki
+//
+//  Copyright (c) 2015 Michigan State University. All rights reserved.
+//     to view the full license, visit:
+//         github.com/Hintzelab/MABE/wiki/License
+
+// This file provides helpers for bit strings packed into 64 bit words.
+// Bit i lives in word i / 64 at position i % 64 (least significant first),
+// so a run of bits can be read out of one or two words with shifts.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace PackedBits {
+
+const int bitsPerWord = 64;
+
+// number of words needed to hold numBits bits
+inline size_t wordCount(size_t numBits) {
+  return (numBits + bitsPerWord - 1) / bitsPerWord;
+}
+
+inline bool getBit(const uint64_t *words, size_t index) {
+  return (words[index / bitsPerWord] >> (index % bitsPerWord)) & 1;
+}
+
+inline void setBit(uint64_t *words, size_t index, bool value) {
+  uint64_t mask = (uint64_t)1 << (index % bitsPerWord);
+  if (value) {
+    words[index / bitsPerWord] |= mask;
+  } else {
+    words[index / bitsPerWord] &= ~mask;
+  }
+}
+
+inline void flipBit(uint64_t *words, size_t index) {
+  words[index / bitsPerWord] ^= (uint64_t)1 << (index % bitsPerWord);
+}
+
+// read numBits (1 to 64) bits starting at bit start, with bit start in the
+// lowest position of the result. If the run crosses a word boundary the
+// following word must exist.
+inline uint64_t readBits(const uint64_t *words, size_t start, int numBits) {
+  size_t word = start / bitsPerWord;
+  int shift = start % bitsPerWord;
+  uint64_t value = words[word] >> shift;
+  if (shift + numBits > bitsPerWord) {
+    value |= words[word + 1] << (bitsPerWord - shift);
+  }
+  if (numBits < bitsPerWord) {
+    value &= ((uint64_t)1 << numBits) - 1;
+  }
+  return value;
+}
+
+// number of set bits in a word
+inline int popCount(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_popcountll(word);
+#else
+  int count = 0;
+  for (; word != 0; word &= word - 1) {
+    count++;
+  }
+  return count;
+#endif
+}
+
+// position of the lowest set bit of a nonzero word
+inline int lowestBit(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(word);
+#else
+  int index = 0;
+  for (; !(word & 1); word >>= 1) {
+    index++;
+  }
+  return index;
+#endif
+}
+
+// reverse the order of the lowest numBits bits of value
+inline uint64_t reverseBits(uint64_t value, int numBits) {
+  uint64_t reversed = 0;
+  for (int b = 0; b < numBits; b++) {
+    reversed = (reversed << 1) | ((value >> b) & 1);
+  }
+  return reversed;
+}
+
+// transpose a 64 x 64 bit matrix held in 64 words, in place: afterwards bit
+// j of word b is what bit b of word j was. Used to turn 64 packed bit strings
+// into one word per bit position, with string j in bit j ("bit slicing").
+inline void transpose64(uint64_t *words) {
+  uint64_t mask = 0x00000000FFFFFFFFULL;
+  for (int width = 32; width != 0; width >>= 1, mask ^= mask << width) {
+    for (int k = 0; k < bitsPerWord; k = ((k | width) + 1) & ~width) {
+      uint64_t swap = ((words[k] >> width) ^ words[k | width]) & mask;
+      words[k] ^= swap << width;
+      words[k | width] ^= swap;
+    }
+  }
+}
+
+// hash of numWords words, for using packed bit strings as map keys
+inline size_t hashWords(const uint64_t *words, size_t numWords) {
+  uint64_t hash = numWords;
+  for (size_t w = 0; w < numWords; w++) {
+    // splitmix64 finalizer on each word, folded into the running hash
+    uint64_t z = words[w] + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    hash ^= z ^ (z >> 31);
+  }
+  return (size_t)hash;
+}
+
+} // namespace PackedBits
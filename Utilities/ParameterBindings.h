@@ -0,0 +1,152 @@
+//  MABE is a product of The Hintze Lab @ MSU
+//     for general research information:
+//         hintzelab.msu.edu
+//     for MABE documentation:
+//         github.com/Hintzelab/MABE/wiki
+//
+//  Copyright (c) 2015 Michigan State University. All rights reserved.
+//     to view the full license, visit:
+//         github.com/Hintzelab/MABE/wiki/License
+
+// This file lets a module read its parameters once into plain typed fields
+// instead of calling ParameterLink::get(PT) (a cache lookup and a couple of
+// shared_ptr copies) every time a value is needed.
+//
+// ParameterBindings ties fields to ParameterLinks for one ParametersTable:
+//
+//   boundParameters.bind(N, nPL); // N = nPL->get(PT), now and on refresh()
+//
+// Objects that are made often (brains, genomes) should not bind their own
+// fields; they hold a SharedParameters<Settings> pointer instead, which is
+// filled in once per ParametersTable and shared by every object using it.
+//
+// ParameterBindings::checkAll() compares every bound field with its
+// parameter and exits if any have drifted (i.e. a parameter was changed
+// after it was bound and refresh() was not called). main calls it once per
+// update when WORLD-debug is set.
+
+#pragma once
+
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Parameters.h"
+
+class ParameterBindings {
+public:
+  ParameterBindings(std::string _owner, std::shared_ptr<ParametersTable> _PT)
+      : owner(_owner), PT(_PT) {
+    std::lock_guard<std::mutex> lock(registryMutex());
+    registry().insert(this);
+  }
+
+  ~ParameterBindings() {
+    std::lock_guard<std::mutex> lock(registryMutex());
+    registry().erase(this);
+  }
+
+  // bound fields belong to the object that owns these bindings
+  ParameterBindings(const ParameterBindings &) = delete;
+  ParameterBindings &operator=(const ParameterBindings &) = delete;
+
+  // set field from link now and every time refresh() is called.
+  // field must live as long as these bindings.
+  template <typename T>
+  void bind(T &field, std::shared_ptr<ParameterLink<T>> link) {
+    auto table = PT;
+    field = link->get(table);
+    bindings.push_back(
+        {link->name, [&field, link, table] { field = link->get(table); },
+         [&field, link, table] { return field == link->get(table); }});
+  }
+
+  // reread every bound parameter
+  void refresh() {
+    for (auto &binding : bindings) {
+      binding.read();
+    }
+  }
+
+  // names of bound parameters whose value no longer matches their field
+  std::vector<std::string> changedParameters() const {
+    std::vector<std::string> changed;
+    for (auto &binding : bindings) {
+      if (!binding.matches()) {
+        changed.push_back(binding.name);
+      }
+    }
+    return changed;
+  }
+
+  // check every live set of bindings, exit if any field is out of date
+  static void checkAll() {
+    std::lock_guard<std::mutex> lock(registryMutex());
+    bool stale = false;
+    for (auto bindings : registry()) {
+      for (auto &name : bindings->changedParameters()) {
+        std::cout << "  ERROR :: parameter \"" << name << "\" used by "
+                  << bindings->owner
+                  << " changed after it was bound (call refresh() after "
+                     "changing parameters)."
+                  << std::endl;
+        stale = true;
+      }
+    }
+    if (stale) {
+      std::cout << "  Exiting." << std::endl;
+      exit(1);
+    }
+  }
+
+private:
+  struct Binding {
+    std::string name;
+    std::function<void()> read;
+    std::function<bool()> matches;
+  };
+
+  std::string owner;
+  std::shared_ptr<ParametersTable> PT;
+  std::vector<Binding> bindings;
+
+  static std::set<ParameterBindings *> &registry() {
+    static std::set<ParameterBindings *> live;
+    return live;
+  }
+  static std::mutex &registryMutex() {
+    static std::mutex registryLock;
+    return registryLock;
+  }
+};
+
+// One read-only Settings per ParametersTable, shared by every object made
+// with that table. Settings needs a constructor taking the table, and should
+// fill its fields with a ParameterBindings member.
+template <class Settings> class SharedParameters {
+public:
+  static std::shared_ptr<const Settings>
+  get(std::shared_ptr<ParametersTable> PT) {
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    auto &settings = cache()[PT->getID()];
+    if (settings == nullptr) {
+      settings = std::make_shared<Settings>(PT);
+    }
+    return settings;
+  }
+
+private:
+  static std::map<long long, std::shared_ptr<const Settings>> &cache() {
+    static std::map<long long, std::shared_ptr<const Settings>> tables;
+    return tables;
+  }
+  static std::mutex &cacheMutex() {
+    static std::mutex cacheLock;
+    return cacheLock;
+  }
+};
@@ -15,14 +15,25 @@
 
 #pragma once
 
+#include <cstdint>
 #include <random>
 
 namespace Random {
 
 using Generator = std::mt19937;
 
+// The generator that getCommonGenerator() returns on this thread, if it is
+// not the common one (see GeneratorScope)
+inline Generator *&threadGenerator() {
+  static thread_local Generator *generator = nullptr;
+  return generator;
+}
+
 // Gives you access to the random number generator in general use
 inline Generator &getCommonGenerator() {
+  if (threadGenerator() != nullptr) {
+    return *threadGenerator();
+  }
   // to seed, do get_common_generator().seed(value);
   static Generator
       common; // This creates "common" which is a (random number) generator.
@@ -33,6 +44,30 @@ inline Generator &getCommonGenerator() {
   return common;
 }
 
+// Returns generator number "stream" of the family of generators named by
+// "seed". Work split into numbered blocks can give each block its own
+// stream, so the numbers it draws do not depend on which thread runs it.
+inline Generator getStream(uint32_t seed, uint64_t stream) {
+  std::seed_seq sequence{seed, (uint32_t)stream, (uint32_t)(stream >> 32)};
+  return Generator(sequence);
+}
+
+// While a GeneratorScope exists, code on the thread that made it which uses
+// the common generator (e.g. genome mutation) draws from "generator"
+// instead. This lets work run on several threads, each with its own stream.
+class GeneratorScope {
+public:
+  explicit GeneratorScope(Generator &generator) : previous(threadGenerator()) {
+    threadGenerator() = &generator;
+  }
+  ~GeneratorScope() { threadGenerator() = previous; }
+  GeneratorScope(const GeneratorScope &) = delete;
+  GeneratorScope &operator=(const GeneratorScope &) = delete;
+
+private:
+  Generator *previous;
+};
+
 // result = Random::getDouble(7.2, 9.5);
 // result is in [7.2, 9.5)
 inline double getDouble(const double lower, const double upper,
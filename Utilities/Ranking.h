@@ -0,0 +1,143 @@
+//  MABE is a product of The Hintze Lab @ MSU
+//     for general research information:
+//         hintzelab.msu.edu
+//     for MABE documentation:
+//         github.com/Hintzelab/MABE/wiki
+//
+//  Copyright (c) 2015 Michigan State University. All rights reserved.
+//     to view the full license, visit:
+//         github.com/Hintzelab/MABE/wiki/License
+
+// This file provides the ranking steps used to measure rank epistasis, for
+// both NKWorld and the standalone analysis tool (analysis/cpp_analysis), so
+// the two always agree. It only depends on the standard library.
+//
+// Items are referred to by index. An order is a permutation of indices, and
+// ranks are 1-based mid-ranks: tied items all get the mean of the ranks they
+// would have had if they were not tied (e.g. scores 3,5,5,5,5,8 => ranks
+// 1,3.5,3.5,3.5,3.5,6). A tie group starts at the lowest score not yet
+// ranked and holds every following score within tieTolerance of it
+// (tieTolerance = 0 for exact ties).
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace Ranking {
+
+// indices of scores in ascending order, equal scores kept in index order
+inline void stableOrder(const std::vector<double> &scores,
+                        std::vector<size_t> &order) {
+  order.resize(scores.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&scores](size_t a, size_t b) {
+    return scores[a] < scores[b];
+  });
+}
+
+// re-sort order by keys, items with equal keys keeping their current places
+// relative to each other
+inline void reorder(const std::vector<double> &keys,
+                    std::vector<size_t> &order) {
+  std::stable_sort(order.begin(), order.end(),
+                   [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+}
+
+// same as stableOrder(scores) where scores only differ from the scores that
+// produced baseOrder by scores[item] (baseOrder may be in any state for item)
+inline void moveInOrder(const std::vector<double> &scores,
+                        const std::vector<size_t> &baseOrder, size_t item,
+                        std::vector<size_t> &order) {
+  order.clear();
+  bool placed = false;
+  for (size_t other : baseOrder) {
+    if (other == item) {
+      continue;
+    }
+    if (!placed && (scores[other] > scores[item] ||
+                    (scores[other] == scores[item] && other > item))) {
+      order.push_back(item);
+      placed = true;
+    }
+    order.push_back(other);
+  }
+  if (!placed) {
+    order.push_back(item);
+  }
+}
+
+// ranks[i] = mid-rank of item i, where order lists the items in ascending
+// order of scores
+inline void midRanks(const std::vector<double> &scores,
+                     const std::vector<size_t> &order, double tieTolerance,
+                     std::vector<double> &ranks) {
+  ranks.resize(scores.size());
+  size_t rank = 0; // number of items already ranked
+  while (rank < order.size()) {
+    double first = scores[order[rank]];
+    size_t tied = 1;
+    while (rank + tied < order.size() &&
+           scores[order[rank + tied]] >= first - tieTolerance &&
+           scores[order[rank + tied]] <= first + tieTolerance) {
+      tied++;
+    }
+    // Equivalent to ((rank + 1) + (rank + tied)) / 2
+    double midRank = (2.0 * rank + tied + 1) / 2.0;
+    for (size_t t = 0; t < tied; t++) {
+      ranks[order[rank + t]] = midRank;
+    }
+    rank += tied;
+  }
+}
+
+struct SignedRankSum {
+  double W;   // sum of signed mid-ranks of the paired differences
+  size_t N_r; // number of pairs with a nonzero difference
+};
+
+// Wilcoxon signed rank sum of the pairs (before[i], after[i]). Differences
+// of zero are dropped, the rest are ranked by absolute value with exact
+// ties. Differences are integers no larger than the largest value, so they
+// are ranked with a counting sort; counts is scratch space.
+inline SignedRankSum signedRankSum(const std::vector<size_t> &before,
+                                   const std::vector<size_t> &after,
+                                   std::vector<int> &counts) {
+  size_t maxValue = 0;
+  for (size_t i = 0; i < before.size(); i++) {
+    maxValue = std::max(maxValue, std::max(before[i], after[i]));
+  }
+  // counts[2 * d] = pairs with after - before = d, counts[2 * d + 1] = pairs
+  // with before - after = d
+  counts.assign(2 * (maxValue + 1), 0);
+  size_t numNonzero = 0;
+  for (size_t i = 0; i < before.size(); i++) {
+    if (after[i] > before[i]) {
+      counts[2 * (after[i] - before[i])]++;
+      numNonzero++;
+    } else if (after[i] < before[i]) {
+      counts[2 * (before[i] - after[i]) + 1]++;
+      numNonzero++;
+    }
+  }
+  // ranks are halves of integers, so this sum is exact in any order
+  double sum = 0;
+  size_t rank = 0;
+  for (size_t d = 1; d <= maxValue; d++) {
+    int positive = counts[2 * d];
+    int negative = counts[2 * d + 1];
+    int tied = positive + negative;
+    if (tied == 0) {
+      continue;
+    }
+    double midRank = (2.0 * rank + tied + 1) / 2.0;
+    sum += midRank * (positive - negative);
+    rank += tied;
+  }
+  return SignedRankSum{sum, numNonzero};
+}
+
+} // namespace Ranking
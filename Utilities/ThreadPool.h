@@ -0,0 +1,141 @@
+//  MABE is a product of The Hintze Lab @ MSU
+//     for general research information:
+//         hintzelab.msu.edu
+//     for MABE documentation:
+//         github.com/Hintzelab/MABE/wiki
+//
+//  Copyright (c) 2015 Michigan State University. All rights reserved.
+//     to view the full license, visit:
+//         github.com/Hintzelab/MABE/wiki/License
+
+// This file provides a small pool of persistent worker threads. A job is a
+// function of the thread index [0, size()); run() hands the job to every
+// thread (the calling thread takes index 0) and returns once all of them
+// have finished. Jobs decide for themselves how to split up work by thread
+// index, so results can be written to fixed slots and merged in a
+// deterministic order afterwards. parallelFor() is built on run() and
+// balances uneven tasks by letting idle threads steal from busy ones.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+  // numThreads < 1 uses one thread per hardware thread
+  explicit ThreadPool(int numThreads = 1) {
+    if (numThreads < 1) {
+      numThreads = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    threadCount = numThreads;
+    for (int t = 1; t < threadCount; t++) {
+      workers.emplace_back([this, t] { workerLoop(t); });
+    }
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(poolMutex);
+      stopping = true;
+    }
+    jobReady.notify_all();
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  int size() const { return threadCount; }
+
+  // call job(threadID) once on every thread and wait for all to finish
+  void run(const std::function<void(int)> &job) {
+    if (threadCount == 1) {
+      job(0);
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(poolMutex);
+      currentJob = &job;
+      pending = threadCount - 1;
+      generation++;
+    }
+    jobReady.notify_all();
+    job(0);
+    std::unique_lock<std::mutex> lock(poolMutex);
+    jobDone.wait(lock, [this] { return pending == 0; });
+    currentJob = nullptr;
+  }
+
+  // call task(taskID, threadID) once for every taskID in [0, numTasks).
+  // Each thread starts on its own contiguous block of tasks (so neighbouring
+  // tasks tend to share a thread) and, once that is exhausted, takes tasks
+  // from the blocks of other threads until none are left.
+  void parallelFor(long long numTasks,
+                   const std::function<void(long long, int)> &task) {
+    std::unique_ptr<TaskBlock[]> blocks(new TaskBlock[threadCount]);
+    for (int t = 0; t < threadCount; t++) {
+      blocks[t].next = numTasks * t / threadCount;
+      blocks[t].end = numTasks * (t + 1) / threadCount;
+    }
+    run([&](int threadID) {
+      for (int offset = 0; offset < threadCount; offset++) {
+        TaskBlock &block = blocks[(threadID + offset) % threadCount];
+        long long taskID = block.next.fetch_add(1);
+        while (taskID < block.end) {
+          task(taskID, threadID);
+          taskID = block.next.fetch_add(1);
+        }
+      }
+    });
+  }
+
+private:
+  struct TaskBlock {
+    std::atomic<long long> next;
+    long long end;
+    char padding[48]; // keep each block's counter on its own cache line
+  };
+
+  int threadCount;
+  std::vector<std::thread> workers;
+  std::mutex poolMutex;
+  std::condition_variable jobReady;
+  std::condition_variable jobDone;
+  const std::function<void(int)> *currentJob = nullptr;
+  long long generation = 0;
+  int pending = 0;
+  bool stopping = false;
+
+  void workerLoop(int threadID) {
+    long long seenGeneration = 0;
+    while (true) {
+      const std::function<void(int)> *job;
+      {
+        std::unique_lock<std::mutex> lock(poolMutex);
+        jobReady.wait(lock, [this, seenGeneration] {
+          return stopping || generation != seenGeneration;
+        });
+        if (stopping) {
+          return;
+        }
+        seenGeneration = generation;
+        job = currentJob;
+      }
+      (*job)(threadID);
+      {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        pending--;
+      }
+      jobDone.notify_one();
+    }
+  }
+};
@@ -16,7 +16,9 @@
 
 #include "../Group/Group.h"
 #include "../Utilities/Utilities.h"
+#include "../Utilities/Checkpoint.h"
 #include "../Utilities/Data.h"
+#include "../Utilities/ParameterBindings.h"
 #include "../Utilities/Parameters.h"
 
 class AbstractWorld {
@@ -26,12 +28,17 @@ public:
 
   const std::shared_ptr<ParametersTable> PT;
 
+  // typed copies of this world's parameters, filled in by bind() (see
+  // Utilities/ParameterBindings.h)
+  ParameterBindings boundParameters;
+
   int requiredInputs = 0;
   int requiredOutputs = 0;
 
   std::vector<std::string> popFileColumns;
 
-  AbstractWorld(std::shared_ptr<ParametersTable> PT_) : PT(PT_) {}
+  AbstractWorld(std::shared_ptr<ParametersTable> PT_)
+      : PT(PT_), boundParameters("world", PT_) {}
   virtual ~AbstractWorld() = default;
 
   virtual std::unordered_map<std::string, std::unordered_set<std::string>>
@@ -46,4 +53,10 @@ public:
 
   virtual void evaluate(std::map<std::string, std::shared_ptr<Group>> &groups,
 	  int analyze = 0, int visualize = 0, int debug = 0) = 0;
+
+  // write or read any state this world changes or draws at random, so that a
+  // run resumed from a checkpoint carries on as if it was never stopped
+  // the undefined action is to save nothing
+  virtual void saveCheckpoint(Checkpoint::Writer &checkpoint) {}
+  virtual void loadCheckpoint(Checkpoint::Reader &checkpoint) {}
 };
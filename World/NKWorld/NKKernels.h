@@ -0,0 +1,192 @@
+//  MABE is a product of The Hintze Lab @ MSU
+//     for general research information:
+//         hintzelab.msu.edu
+//     for MABE documentation:
+//         github.com/Hintzelab/MABE/wiki
+//
+//  Copyright (c) 2015 Michigan State University. All rights reserved.
+//     to view the full license, visit:
+//         github.com/Hintzelab/MABE/wiki/License
+
+// NK scoring kernels, templated on K so that the loops over the sites of a
+// window and the shifts that build table indices are fixed at compile time.
+// KT = 0 is the generic kernel, which reads K at run time. NKWorld picks one
+// set of kernels when it is built (see select).
+//
+// Genomes are packed as in NKWorld: N bits followed by the first K-1 bits
+// again, so no window wraps around. Table values are indexed by locus and by
+// a window's bits with its first site in the lowest bit. They are read from
+// localValues (N rows of 2^K values) or, for hashed tables, derived from the
+// table's seed (see hashedValue).
+//
+// Table values are summed in fixed point: each is rounded to a whole number
+// of 1/scale (see toFixed), so sums are exact in any order and every kernel,
+// and NKWorld's incremental scoring, gives exactly the same score.
+
+#pragma once
+
+#include "../../Utilities/PackedBits.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace NKKernels {
+
+// What the kernels read from an NKWorld
+struct Landscape {
+  int N;
+  int K;
+  const int64_t *localValues; // in fixed point
+  const std::pair<int, int64_t> *patterns; // sparse tables only: (index, value)
+  size_t numPatterns;
+  double scale; // a power of 2: values are stored as multiples of 1/scale
+  uint64_t hashSeed; // hashed tables only
+};
+
+// A table value in fixed point
+inline int64_t toFixed(double value, double scale) {
+  return (int64_t)std::llround(value * scale);
+}
+
+// Score of a genome whose table values (in fixed point) sum to W
+inline double score(const Landscape &landscape, int64_t W) {
+  return (double)W / landscape.scale / (double)landscape.N;
+}
+
+// splitmix64 finalizer
+inline uint64_t mix64(uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// Entry (n, index) of a hashed table, in [0, 1): component 0 is alpha, 1 is
+// beta. Each value depends only on the seed and its position (a counter-based
+// generator), so any entry can be made on its own and the whole table is 
+// reproducible from the seed.
+inline double hashedValue(uint64_t seed, int n, int index, int component) {
+  uint64_t counter = ((((uint64_t)(uint32_t)n << 32) | (uint32_t)index) << 1) | component;
+  uint64_t z = mix64(mix64(counter ^ mix64(seed + 0x9e3779b97f4a7c15ULL)) + 0x9e3779b97f4a7c15ULL);
+  return (z >> 11) * (1.0 / (double)((uint64_t)1 << 53));
+}
+
+// Table values read from localValues
+struct StoredValues {
+  static int64_t get(const Landscape &landscape, int k, int n, int index) {
+    return landscape.localValues[((size_t)n << k) | index];
+  }
+};
+
+// Table values derived from the seed of a hashed (static) table
+struct HashedValues {
+  static int64_t get(const Landscape &landscape, int, int n, int index) {
+    return toFixed(hashedValue(landscape.hashSeed, n, index, 0), landscape.scale);
+  }
+};
+
+// Score of a packed genome, with each window read by a shift
+template <int KT, typename Values>
+double scoreWindows(const Landscape &landscape, const uint64_t *packed) {
+  const int k = KT > 0 ? KT : landscape.K;
+  int64_t W = 0;
+  for (int n = 0; n < landscape.N; n++) {
+    W += Values::get(landscape, k, n, PackedBits::readBits(packed, n, k));
+  }
+  return score(landscape, W);
+}
+
+// Score of a packed genome for a sparse table: for 64 loci at a time, the
+// windows matching a pattern are found by ANDing the genome shifted by 0 to
+// K-1 sites (complemented where the pattern has a 0)
+template <int KT>
+double scoreSparse(const Landscape &landscape, const uint64_t *packed) {
+  const int k = KT > 0 ? KT : landscape.K;
+  const int N = landscape.N;
+  int64_t W = 0;
+  uint64_t shifted[KT > 0 ? KT : 32]; // K is at most 31 (table indices are ints)
+  for (int first = 0; first < N; first += PackedBits::bitsPerWord) {
+    int loci = std::min(PackedBits::bitsPerWord, N - first);
+    uint64_t valid = loci < PackedBits::bitsPerWord ? ((uint64_t)1 << loci) - 1 : ~(uint64_t)0;
+    for (int s = 0; s < k; s++) {
+      shifted[s] = PackedBits::readBits(packed, first + s, loci);
+    }
+    for (size_t p = 0; p < landscape.numPatterns; p++) {
+      uint64_t match = valid;
+      int pattern = landscape.patterns[p].first;
+      for (int s = 0; s < k; s++) {
+        match &= ((pattern >> s) & 1) ? shifted[s] : ~shifted[s];
+      }
+      W += landscape.patterns[p].second * PackedBits::popCount(match);
+    }
+  }
+  return score(landscape, W);
+}
+
+// Score count (up to 64) sliced genomes: word b of slices holds site b of
+// every genome, genome j in bit j. Every lane keeps the table index of its
+// current window; moving to the next window shifts out the site leaving it
+// and shifts in the site entering it, read from the next slice.
+template <int KT, typename Values>
+void scoreSlices(const Landscape &landscape, const uint64_t *slices, int count,
+                 double *scores) {
+  const int k = KT > 0 ? KT : landscape.K;
+  int64_t W[PackedBits::bitsPerWord] = {};
+  int index[PackedBits::bitsPerWord] = {};
+  for (int s = 0; s < k - 1; s++) {
+    for (int j = 0; j < count; j++) {
+      index[j] |= (int)((slices[s] >> j) & 1) << (s + 1);
+    }
+  }
+  for (int n = 0; n < landscape.N; n++) {
+    uint64_t entering_site = slices[n + k - 1];
+    for (int j = 0; j < count; j++) {
+      index[j] = (index[j] >> 1) | ((int)((entering_site >> j) & 1) << (k - 1));
+      W[j] += Values::get(landscape, k, n, index[j]);
+    }
+  }
+  for (int j = 0; j < count; j++) {
+    scores[j] = score(landscape, W[j]);
+  }
+}
+
+// One set of kernels, all built for the same K
+struct Kernels {
+  int K; // 0 = generic
+  double (*windows)(const Landscape &landscape, const uint64_t *packed);
+  double (*sparse)(const Landscape &landscape, const uint64_t *packed);
+  void (*slices)(const Landscape &landscape, const uint64_t *slices, int count,
+                 double *scores);
+};
+
+// Kernels for K = KT, reading table values through Values. Hashed tables
+// are never sparse, so their sparse kernel is never used.
+template <int KT, typename Values = StoredValues> Kernels kernelsFor() {
+  return {KT, &scoreWindows<KT, Values>, &scoreSparse<KT>, &scoreSlices<KT, Values>};
+}
+
+template <typename Values> Kernels select(int K) {
+  switch (K) {
+  case 3:
+    return kernelsFor<3, Values>();
+  case 5:
+    return kernelsFor<5, Values>();
+  case 6:
+    return kernelsFor<6, Values>();
+  case 10:
+    return kernelsFor<10, Values>();
+  default:
+    return kernelsFor<0, Values>();
+  }
+}
+
+// The kernels specialized for K, or the generic kernels if there are none
+// (K = 0 always gives the generic kernels). The specialized values are the
+// ones our experiments use.
+inline Kernels select(int K, bool hashed = false) {
+  return hashed ? select<HashedValues>(K) : select<StoredValues>(K);
+}
+
+} // namespace NKKernels
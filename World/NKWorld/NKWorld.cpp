@@ -16,7 +16,7 @@
 
 #include "NKWorld.h"
 #include "../../Utilities/Random.h"
-#include "../../Genome/CircularGenome/CircularGenome.h"
+#include "../../Utilities/EditDistance.h"
 #include "../../Brain/ConstantValuesBrain/ConstantValuesBrain.h"
 #include <vector>
 #include <map>
@@ -24,238 +24,11 @@
 #include <set>
 #include <iostream>
 #include <fstream>
+#include <cmath>
+#include <climits>
 
 #define PI 3.14159265
 
-template <typename T>
-class Matrix2D{
-private:
-    std::vector<T> vec;
-    size_t num_rows;
-    size_t num_cols;
-public:
-    Matrix2D(size_t r, size_t c, T val){
-        num_rows = r;
-        num_cols = c;
-        vec.resize(num_rows * num_cols, val);
-    }
-    inline T Get(size_t row, size_t col){
-        if(row >= num_rows || col >= num_cols){
-            std::cerr << "Error! Matrix index out of bounds!" << std::endl;
-            std::cerr << "Requested: (" << row << ", " << col << ")" << std::endl;
-            std::cerr << "Matrix size: (" << num_rows << ", " << num_cols << ")" << std::endl;
-        }
-        return vec[row * num_cols + col];
-    }
-    void Set(int row, int col, T val){
-        vec[row * num_cols + col] = val;
-    }
-    void Print(std::ostream& os = std::cout){
-        for(size_t row = 0; row < num_rows; ++row){
-            for(size_t col = 0; col < num_cols; ++col){
-                std::cout << Get(row, col) << " ";
-            }
-            std::cout << std::endl;
-        }
-    }
-    void PrintWithLabels(const std::vector<T>& row_labels, const std::vector<T>& col_labels,
-            std::ostream& os =  std::cout){
-        std::cout << "xxx xxx xxx ";
-        for(size_t col = 0; col < num_cols - 2; ++col){
-            if(col_labels[col] < 10) std::cout << "  " << col_labels[col] << " ";
-            else if(col_labels[col] < 100) std::cout << " " << col_labels[col] << " ";
-            else std::cout << col_labels[col] << " ";
-        }
-        std::cout << std::endl;
-        for(size_t row = 0; row < num_rows; ++row){
-            if(row <= 1) std::cout << "xxx ";
-            else{
-                if(row_labels[row - 2] < 10) std::cout << "  " << row_labels[row - 2] << " ";
-                else if(row_labels[row - 2] < 100) std::cout << " " << row_labels[row - 2] << " ";
-                else std::cout <<  row_labels[row - 2] << " ";
-            }
-            for(size_t col = 0; col < num_cols; ++col){
-                if(Get(row, col) < 10) std::cout << "  " << Get(row, col) << " ";
-                else if(Get(row, col) < 100) std::cout << " " << Get(row, col) << " ";
-                else std::cout << Get(row, col) << " ";
-            }
-            std::cout << std::endl;
-        }
-    }
-};
-
-
-enum EditDistanceMetric{
-    kLevenshtein = 0,
-    kDamerau_Levenshtein = 1
-};
-
-// Levenshtein 
-// Implemented from psuedocode at https://en.wikipedia.org/wiki/Levenshtein_distance
-double EditDistance_L(const std::vector<size_t>& vec_a, const std::vector<size_t>& vec_b){
-    Matrix2D<size_t> matrix(vec_a.size() + 1, vec_b.size() + 1, 0);
-    for(size_t i = 0; i <= vec_a.size(); ++i) matrix.Set(i, 0, i);
-    for(size_t j = 0; j <= vec_b.size(); ++j) matrix.Set(0, j, j);
-    size_t sub_cost = 0;
-    for(size_t j = 1; j <= vec_b.size(); ++j){
-        for(size_t i = 1; i <= vec_a.size(); ++i){
-            sub_cost = (vec_a[i-1] == vec_b[j-1]) ? 0 : 1;
-            matrix.Set(i, j, std::min({
-                matrix.Get(i, j - 1) + 1,
-                matrix.Get(i - 1, j) + 1,
-                matrix.Get(i - 1, j - 1) + sub_cost }));
-        }
-    }
-    //matrix.Print();
-    return matrix.Get(vec_a.size() - 1, vec_b.size() - 1);
-}
-
-// Damerau-Levenshtein
-// From psuedocode at https://en.wikipedia.org/wiki/Damerau%E2%80%93Levenshtein_distance 
-// Also useful for understanding: https://www.lemoda.net/text-fuzzy/damerau-levenshtein/index.html
-double EditDistance_DL(const std::vector<size_t>& vec_a, const std::vector<size_t>& vec_b){
-    std::vector<size_t> row_labels = {0, 0};
-    for(size_t x : vec_a) row_labels.push_back(x);
-    std::vector<size_t> col_labels = {0};
-    for(size_t x : vec_b) col_labels.push_back(x);
-    
-    size_t max_a = *std::max_element(vec_a.begin(), vec_a.end());
-    size_t max_b = *std::max_element(vec_b.begin(), vec_b.end());
-    std::vector<size_t> da(std::max(max_a, max_b) + 1, 1);
-    Matrix2D<size_t> matrix(vec_a.size() + 2, vec_b.size() + 2, 0);
-    size_t max_dist = vec_a.size() + vec_b.size();    
-    matrix.Set(0, 0, max_dist);
-    for(size_t i = 0; i <= vec_a.size() + 1; ++i){
-        matrix.Set(i, 0, max_dist);
-        matrix.Set(i, 1, i - 1);
-    }
-    for(size_t j = 1; j <= vec_b.size() + 1; ++j){
-        matrix.Set(0, j, max_dist);
-        matrix.Set(1, j, j - 1);
-    }
-
-
-    for(size_t i = 2; i <= vec_a.size() + 1; ++i){
-        size_t db = 1;
-        for(size_t j = 2; j <= vec_b.size() + 1; ++j){
-            size_t k = da[vec_b[j - 2]]; // Last row we saw current symbol in vec_b
-            size_t l = db;
-            size_t cost = 0;
-            if(vec_a[i - 2] == vec_b[j - 2]){
-                cost = 0;
-                db = j;
-            }
-            else
-                cost = 1;
-            matrix.Set(i, j, std::min({
-                matrix.Get(i - 1, j - 1) + cost,  // Substitution
-                matrix.Get(i, j - 1) + 1, // Insertion
-                matrix.Get(i - 1, j) + 1, // Deletion
-                matrix.Get(k - 1, l - 1) + (i - k - 1) + 1 + (j - l - 1) // Transposition
-            }));
-        }
-        da[vec_a[i - 2]] = i; // The last row we current symbol win vec_a is this one!
-    }
-    //matrix.PrintWithLabels(vec_a, vec_b);
-    return matrix.Get(vec_a.size() + 1, vec_b.size() + 1);
-}
-
-struct WilcoxPair{
-  double abs_diff;
-  int sign;
-  double rank;
-};
-struct WilcoxResult{
-  double W;
-  size_t N_r;
-};
-// Wilcoxon signed rank-sum
-// Implemented from: https://en.wikipedia.org/wiki/Wilcoxon_signed-rank_test
-WilcoxResult Wilcoxon_W(const std::vector<size_t>& vec_orig, const std::vector<size_t>& vec_mut){
-  size_t num_zeros = 0; // We ignore all pairs with difference 0
-  // Fill new vector with the paired differences
-  static std::vector<WilcoxPair> rank_vec(vec_orig.size());
-  for(size_t idx = 0; idx < rank_vec.size(); ++idx){
-    rank_vec[idx].abs_diff = (double)vec_mut[idx] - (double)vec_orig[idx];
-    if(rank_vec[idx].abs_diff < 0){
-      rank_vec[idx].abs_diff = -1 * rank_vec[idx].abs_diff;
-      rank_vec[idx].sign = -1;
-    }
-    else if(rank_vec[idx].abs_diff == 0){
-      rank_vec[idx].sign = 0;
-      ++num_zeros;
-    }
-    else{
-      rank_vec[idx].sign = 1;
-    }
-  }
-  // Sort the new vector by the absolute difference
-  std::stable_sort(rank_vec.begin(), rank_vec.end(),
-              [](const WilcoxPair& a, const WilcoxPair& b){
-             return a.abs_diff < b.abs_diff;
-          });
-  size_t rank = 0;     // Current rank to be assigned
-  size_t rank_idx = 0; // Current index to assign a rank to
-  size_t offset = 0;   // How many scores (this + following) have the same score?
-  // Repeated scores should have the same rank
-  // This rank is the midpoint of the ranks if they were sequential
-  // e.g. (from Wikipedia) scores = 3,5,5,5,5,8 => ranks 1,3.5,3.5,3.5,3.5,6
-  while(rank_idx < rank_vec.size()){
-    offset = 1;
-    while(true){
-      // If the next number is not the same, stop! (also stop if we run off the end)
-      if(rank_idx + offset >= rank_vec.size()  || 
-          rank_vec[rank_idx + offset].abs_diff != rank_vec[rank_idx].abs_diff){
-        break;
-      }
-      ++offset;
-    }
-    // If values were 0, assign rank 0
-    if(rank_vec[rank_idx].abs_diff == 0){
-      for(size_t tmp_offset = 0; tmp_offset < offset; ++tmp_offset){
-        rank_vec[rank_idx + tmp_offset].rank = 0;
-      }
-      rank_idx += offset;
-    }
-    // Else, find the midpoint, and put it in each slot with the same score
-    else{
-      for(size_t tmp_offset = 0; tmp_offset < offset; ++tmp_offset){
-        // Equivalent to ((rank + 1) + (rank + offset)) / 2
-        rank_vec[rank_idx + tmp_offset].rank = (2.0 * rank + offset + 1) / 2 ;
-      }
-      rank_idx += offset;
-      rank += offset;
-    }
-  }
-  // Sum rank x sign for each pair 
-  double sum = 0; 
-  for(size_t idx = 0; idx < rank_vec.size(); ++idx){
-      sum += rank_vec[idx].rank * rank_vec[idx].sign;
-  }
-  // Return W value
-  return WilcoxResult{sum, rank_vec.size() - num_zeros};
-}
-
-
-// General edit distance function that will direct you to the specified metric
-double EitDistance(const std::vector<size_t>& vec_a, const std::vector<size_t>& vec_b, 
-        EditDistanceMetric metric){
-    switch(metric){
-        case kLevenshtein:
-            return EditDistance_L(vec_a, vec_b);    
-        break;
-        case kDamerau_Levenshtein:
-            return EditDistance_DL(vec_a, vec_b);    
-        break;
-        default:
-            std::cerr << "Error! Unknown edit distance metric!" << std::endl;
-            exit(-1);
-            return 0;
-        break;
-    }
-    return 0;
-}
-
 std::shared_ptr<ParameterLink<int>> NKWorld::nPL =
 Parameters::register_parameter("WORLD_NK-n", 4,
         "number of outputs (e.g. traits, loci)");
@@ -279,6 +52,21 @@ std::shared_ptr<ParameterLink<bool>> NKWorld::writeNKTablePL =
 Parameters::register_parameter("WORLD_NK-writeNKTable", true,
         "do you want the NK table to be output for each replicate? "
         "0 = no output, 1 = please output");
+std::shared_ptr<ParameterLink<std::string>> NKWorld::writeNKTableLociPL =
+Parameters::register_parameter("WORLD_NK-writeNKTableLoci", (std::string) ":1",
+        "If writeNKTable is 1, which loci to write (same format as dataSequence, "
+        "e.g. '0-9,100'). If not every locus is written, the first row of "
+        "NKTable.csv holds the loci written");
+std::shared_ptr<ParameterLink<bool>> NKWorld::hashNKTablePL =
+Parameters::register_parameter("WORLD_NK-hashNKTable", false,
+        "If true, table entries are not stored but derived from "
+        "hashNKTableSeed and their position with a counter-based hash, so the "
+        "table takes no memory (for very large N and K) and is the same for "
+        "the same seed. Static landscapes only, and readNKTable must be 0");
+std::shared_ptr<ParameterLink<int>> NKWorld::hashNKTableSeedPL =
+Parameters::register_parameter("WORLD_NK-hashNKTableSeed", -1,
+        "If hashNKTable is 1, the seed of the table. -1 = draw it from the "
+        "random number generator");
 std::shared_ptr<ParameterLink<double>> NKWorld::velocityPL =
 Parameters::register_parameter("WORLD_NK-velocity", 0.01,
         "If treadmilling, how fast should it treadmill? "
@@ -288,6 +76,31 @@ Parameters::register_parameter("WORLD_NK-evaluationsPerGeneration", 1,
         "Number of times to test each Genome per "
         "generation (useful with non-deterministic "
         "brains)");
+std::shared_ptr<ParameterLink<int>> NKWorld::evaluationThreadsPL =
+Parameters::register_parameter("WORLD_NK-evaluationThreads", 1,
+        "Number of threads used to evaluate the population and to record "
+        "rank epistasis (results do not depend on this value). "
+        "1 = serial, 0 = one thread per hardware thread");
+std::shared_ptr<ParameterLink<int>> NKWorld::fitnessCacheSizePL =
+Parameters::register_parameter("WORLD_NK-fitnessCacheSize", 100000,
+        "Number of genotypes whose fitness is remembered so that repeated "
+        "genotypes are only scored once (the cache is emptied when full, and "
+        "every update if treadmilling). Hits and misses of the population's "
+        "evaluation in each update are written to the pop file. 0 = no cache "
+        "(and no hit and miss columns)");
+std::shared_ptr<ParameterLink<int>> NKWorld::evaluationMethodPL =
+Parameters::register_parameter("WORLD_NK-evaluationMethod", 1,
+        "How to score genomes. 0 = one genome at a time, "
+        "1 = bit-sliced, 64 genomes at a time (the population, mutant fitness "
+        "and full re-evaluation of rank epistasis mutants), "
+        "2 = regression (score the population both ways, exit with an error "
+        "if any score differs)");
+std::shared_ptr<ParameterLink<bool>> NKWorld::sparseTablesPL =
+Parameters::register_parameter("WORLD_NK-sparseTables", true,
+        "If the table is the same on every row and mostly 0 (like "
+        "fit_flat_3.dat), score genomes by finding each nonzero pattern at "
+        "every locus at once with word operations, instead of one table "
+        "lookup per locus. Scores are unchanged");
 std::shared_ptr<ParameterLink<std::string>> NKWorld::groupNamePL =
 Parameters::register_parameter("WORLD_NK_NAMES-groupNameSpace",
         (std::string) "root::",
@@ -306,7 +119,21 @@ Parameters::register_parameter("WORLD_NK_OUTPUT-outputRankEpistasisInterval",
 std::shared_ptr<ParameterLink<int>> NKWorld::outputEditDistanceMetricPL =
 Parameters::register_parameter("WORLD_NK_OUTPUT-outputEditDistanceMetric", 
         0,
-        "Which edit distance to use. 0 for Levenshtein, 1 for Damerau-Levenshtein");
+        "Which edit distance to use. 0 for Levenshtein, 1 for Damerau-Levenshtein, "
+        "2 for insertions and deletions only, 3 for Levenshtein without bit vectors "
+        "(slower, for checking 0)");
+std::shared_ptr<ParameterLink<int>> NKWorld::rankEpistasisEvaluationPL =
+Parameters::register_parameter("WORLD_NK_OUTPUT-rankEpistasisEvaluation", 
+        0,
+        "How to score mutants when recording rank epistasis. "
+        "0 = incremental (rescore only the windows touched by each mutation), "
+        "1 = full re-evaluation of every mutant, "
+        "2 = regression (run both, exit with an error if any row differs)");
+std::shared_ptr<ParameterLink<double>> NKWorld::rankTieTolerancePL =
+Parameters::register_parameter("WORLD_NK_OUTPUT-rankTieTolerance", 
+        0.0001,
+        "When ranking mutants for rank epistasis, scores within this of the "
+        "lowest score in a group share a rank (0 = only equal scores share a rank)");
 
 std::shared_ptr<ParameterLink<bool>> NKWorld::outputMutantFitnessPL =
 Parameters::register_parameter("WORLD_NK_OUTPUT-outputMutantFitness", false,
@@ -320,6 +147,26 @@ Parameters::register_parameter("WORLD_NK_OUTPUT-outputMutantFitnessInterval",
         100,
         "If we output mutant fitness, how often do we do so?");
 
+std::shared_ptr<ParameterLink<bool>> NKWorld::outputLandscapePL =
+Parameters::register_parameter("WORLD_NK_OUTPUT-outputLandscape", false,
+        "If true, score all 2^N genotypes (N at most 32) and output the best "
+        "score, the number of local optima and landscape-wide rank epistasis. "
+        "If rankEpistasisEvaluation is 2, every genotype is also checked "
+        "against full re-evaluation");
+std::shared_ptr<ParameterLink<std::string>> NKWorld::outputLandscapeFilenamePL =
+Parameters::register_parameter("WORLD_NK_OUTPUT-outputLandscapeFilename", 
+        (std::string)"landscape.csv",
+        "If we output the landscape, where to save it?");
+std::shared_ptr<ParameterLink<int>> NKWorld::outputLandscapeIntervalPL =
+Parameters::register_parameter("WORLD_NK_OUTPUT-outputLandscapeInterval", 
+        100,
+        "If we output the landscape, how often do we do so? (a static landscape "
+        "only needs it once)");
+std::shared_ptr<ParameterLink<bool>> NKWorld::landscapeRankEpistasisPL =
+Parameters::register_parameter("WORLD_NK_OUTPUT-landscapeRankEpistasis", true,
+        "If we output the landscape, also record rank epistasis at every "
+        "genotype and locus (about N times slower)");
+
 std::shared_ptr<ParameterLink<std::string>> NKWorld::brainNamePL =
 Parameters::register_parameter(
         "WORLD_NK_NAMES-brainNameSpace", (std::string) "root::",
@@ -328,26 +175,94 @@ Parameters::register_parameter(
 NKWorld::NKWorld(std::shared_ptr<ParametersTable> PT_)
     : AbstractWorld(PT_) {
 
-    // localize N & K parameters
-    N = nPL->get(PT);
-    K = kPL->get(PT);
+    // localize parameters
+    boundParameters.bind(N, nPL);
+    boundParameters.bind(K, kPL);
+    boundParameters.bind(treadmill, treadmillPL);
+    boundParameters.bind(velocity, velocityPL);
+    boundParameters.bind(evaluations_per_generation, evaluationsPerGenerationPL);
+    boundParameters.bind(group_name, groupNamePL);
+    boundParameters.bind(brain_name, brainNamePL);
+    boundParameters.bind(fitness_cache_size, fitnessCacheSizePL);
+    fitness_cache_update = -1;
+    fitness_cache_hits = 0;
+    fitness_cache_misses = 0;
+
+    // Worker threads for evaluation, each with its own scratch buffer
+    evaluation_pool = std::make_shared<ThreadPool>(evaluationThreadsPL->get(PT));
+    packed_words = PackedBits::wordCount(N + K - 1);
+    thread_packed_data.resize(evaluation_pool->size(), std::vector<uint64_t>(packed_words, 0));
+    boundParameters.bind(evaluation_method, evaluationMethodPL);
+    boundParameters.bind(sparse_tables, sparseTablesPL);
+    if(evaluation_method < kScalarEvaluation || evaluation_method > kBitSlicedRegression){
+        std::cerr << "ERROR! Unknown WORLD_NK-evaluationMethod: " 
+                  << evaluation_method << std::endl;
+        exit(-1);
+    }
+    thread_slices.resize(evaluation_pool->size(), 
+            std::vector<uint64_t>(packed_words * PackedBits::bitsPerWord, 0));
+    thread_slice_scores.resize(evaluation_pool->size(), 
+            std::vector<double>(PackedBits::bitsPerWord, 0));
 
-    output_rank_epistasis =          outputRankEpistasisPL->get(PT);
-    output_rank_epistasis_filename = outputRankEpistasisFilenamePL->get(PT);
-    output_rank_epistasis_interval = outputRankEpistasisIntervalPL->get(PT);
-    edit_distance_metric = outputEditDistanceMetricPL->get(PT);
+    boundParameters.bind(output_rank_epistasis, outputRankEpistasisPL);
+    boundParameters.bind(output_rank_epistasis_filename, outputRankEpistasisFilenamePL);
+    boundParameters.bind(output_rank_epistasis_interval, outputRankEpistasisIntervalPL);
+    boundParameters.bind(edit_distance_metric, outputEditDistanceMetricPL);
+    if(edit_distance_metric < kLevenshtein || edit_distance_metric > kLevenshteinRows){
+        std::cerr << "ERROR! Unknown WORLD_NK_OUTPUT-outputEditDistanceMetric: " 
+                  << edit_distance_metric << std::endl;
+        exit(-1);
+    }
+    boundParameters.bind(rank_epistasis_evaluation, rankEpistasisEvaluationPL);
+    boundParameters.bind(rank_tie_tolerance, rankTieTolerancePL);
+    if(rank_epistasis_evaluation < kIncremental || rank_epistasis_evaluation > kRegression){
+        std::cerr << "ERROR! Unknown WORLD_NK_OUTPUT-rankEpistasisEvaluation: " 
+                  << rank_epistasis_evaluation << std::endl;
+        exit(-1);
+    }
     
-    output_mutant_fitness =          outputMutantFitnessPL->get(PT);
-    output_mutant_fitness_filename = outputMutantFitnessFilenamePL->get(PT);
-    output_mutant_fitness_interval = outputMutantFitnessIntervalPL->get(PT);
+    boundParameters.bind(output_mutant_fitness, outputMutantFitnessPL);
+    boundParameters.bind(output_mutant_fitness_filename, outputMutantFitnessFilenamePL);
+    boundParameters.bind(output_mutant_fitness_interval, outputMutantFitnessIntervalPL);
+
+    boundParameters.bind(output_landscape, outputLandscapePL);
+    boundParameters.bind(output_landscape_filename, outputLandscapeFilenamePL);
+    boundParameters.bind(output_landscape_interval, outputLandscapeIntervalPL);
+    boundParameters.bind(landscape_rank_epistasis, landscapeRankEpistasisPL);
+    if(output_landscape && N > 32){
+        std::cerr << "ERROR! WORLD_NK_OUTPUT-outputLandscape needs N of at most 32, "
+                  << "but N is " << N << std::endl;
+        exit(-1);
+    }
+
+    // A hashed table is never stored: its entries are made when they are read
+    boundParameters.bind(hash_nk_table, hashNKTablePL);
+    hash_nk_table_seed = 0;
+    if (hash_nk_table) {
+        if (treadmill || readNKTablePL->get(PT)) {
+            std::cerr << "ERROR! WORLD_NK-hashNKTable needs a static landscape "
+                      << "(treadmill = 0) that is not read from file (readNKTable = 0)" 
+                      << std::endl;
+            exit(-1);
+        }
+        hash_nk_table_seed = hashNKTableSeedPL->get(PT) >= 0 ? 
+            (uint64_t)hashNKTableSeedPL->get(PT) : (uint64_t)Random::getInt(0, INT_MAX);
+        std::cout << "Using hashed NK table with seed " << hash_nk_table_seed << std::endl;
+    }
+    kernels = NKKernels::select(K, hash_nk_table);
 
     // generate NK lookup table
     // dimensions: N x 2^K
     // each value is a randomly generated pair of doubles, each in [0.0,1.0]
     // represents weighting on the fitness fcn for each k-tuple in the brain output state
+    // (entries are read and written in the usual first-site-highest order, 
+    // and stored at the reversed index)
     NKTable.clear();
-    NKTable.resize(N);
-    if(readNKTablePL->get(PT)){
+    if(hash_nk_table){
+        // nothing is stored: tableEntry makes each entry from the seed
+    }
+    else if(readNKTablePL->get(PT)){
+        NKTable.resize((size_t)N << K);
         std::cout << "Attempting to read NK table from file: " << inputNKTableFilenamePL->get(PT) 
                   << std::endl;
         std::ifstream tableFP;
@@ -360,10 +275,9 @@ NKWorld::NKWorld(std::shared_ptr<ParametersTable> PT_)
         double cur_val = 0;
         std::cout << "NK table:" << std::endl;
         for(size_t n = 0; n < N; ++n){
-            NKTable[n].resize(1<<K);
             for(int k=0;k<(1<<K);k++){
                 tableFP >> cur_val;
-                NKTable[n][k]= std::pair<double,double>(cur_val, 0);
+                NKTable[tableIndex(n, PackedBits::reverseBits(k, K))]= std::pair<double,double>(cur_val, 0);
                 if(k != 0) std::cout << " ";
                 std::cout << cur_val;
             }
@@ -371,31 +285,29 @@ NKWorld::NKWorld(std::shared_ptr<ParametersTable> PT_)
         } 
     }
     else{
+        NKTable.resize((size_t)N << K);
         for(int n=0;n<N;n++){
-            NKTable[n].resize(1<<K);
             for(int k=0;k<(1<<K);k++){
-                NKTable[n][k]= std::pair<double,double>(Random::getDouble(0.0,1.0),Random::getDouble(0.0,1.0));
+                NKTable[tableIndex(n, PackedBits::reverseBits(k, K))]= std::pair<double,double>(Random::getDouble(0.0,1.0),Random::getDouble(0.0,1.0));
             }
         }  
     }
 
     if (writeNKTablePL->get(PT)) {
-        std::ofstream NKTable_csv;
-        NKTable_csv.open("NKTable.csv");
-        for(int k=0;k<(1<<K);k++){
-            for(int n=0;n<N;n++){
-                NKTable_csv << NKTable[n][k].first;
-                // we don't want commas on the last one
-                if (n < N-1) {
-                    NKTable_csv << ",";
-                } else {
-                    NKTable_csv << "\n";
-                }
-            }
-        }
-        NKTable_csv.close();
+        writeNKTableFile();
     }
 
+    // fixed terms of the triangleSin series
+    triangle_coefficients.resize(N);
+    for (int i = 0; i<N; i++) {
+        double n = (2*i) + 1;
+        triangle_coefficients[i] = pow(-1, (double)i)*pow(n, -2.0);
+    }
+    setFixedScale();
+    localValues.resize(NKTable.size());
+    local_values_update = -1;
+    updateLocalValues();
+
     // columns to be added to ave file
     popFileColumns.clear();
     popFileColumns.push_back("score");
@@ -403,12 +315,36 @@ NKWorld::NKWorld(std::shared_ptr<ParametersTable> PT_)
     // variance (performed automatically
     // because _VAR)
     
-    // Resize the necessary vectors 
-    rank_vec_original.resize(N);   
-    rank_vec_mutated.resize(N);
-    mutant_data_vec.resize(N);   
-    // Original rank vector is always [0,N) 
-    std::iota(rank_vec_original.begin(), rank_vec_original.end(), 0);
+    // Resize the necessary vectors, one set per thread
+    rank_epistasis_scratch.resize(evaluation_pool->size());
+    for(auto& scratch : rank_epistasis_scratch){
+        scratch.cached_org_idx = -1;
+        scratch.single_scores.resize(N);
+        scratch.single_scores_full.resize(N);
+        scratch.score_mutant.resize(N);
+        scratch.score_mutant_full.resize(N);
+        scratch.rank_vec_original.resize(N);   
+        scratch.rank_vec_mutated.resize(N);
+        scratch.delta_state.flip_masks.resize(N, 0);
+        scratch.delta_state.touched_windows.reserve(2 * K);
+    }
+
+    // Map each locus to the windows it falls in, along with the bits it 
+    // occupies in each window's table index (more than one if K > N)
+    flipWindows.clear();
+    flipWindows.resize(N);
+    for(int n = 0; n < N; n++){
+        for(int k = 0; k < K; k++){
+            int locus = (n + k) % N;
+            int mask = 1 << k;
+            auto window = std::find_if(flipWindows[locus].begin(), flipWindows[locus].end(),
+                [n](const std::pair<int,int>& w){ return w.first == n; });
+            if(window == flipWindows[locus].end())
+                flipWindows[locus].push_back({n, mask});
+            else
+                window->second |= mask;
+        }
+    }
 }
 
 // create angular sin function for more even fitness distribution
@@ -416,51 +352,372 @@ double NKWorld::triangleSin(double x) {
     double Y = 0.0;
     for (int i = 0; i<N; i++) {
         double n = (2*i) + 1;
-        Y += pow(-1, (double)i)*pow(n, -2.0)*sin(n*x);
+        Y += triangle_coefficients[i]*sin(n*x);
     }
     return (0.25*PI)*Y;
 }
 
-double NKWorld::evaluateData(const std::vector<uint8_t>& data){
-  double t = Global::update*(velocityPL->get(PT));
-  // fitness function
-  double W = 0.0;
+// Write the table, one row per window value and one column per locus in
+// writeNKTableLoci
+void NKWorld::writeNKTableFile() {
+    std::vector<int> loci = seq(writeNKTableLociPL->get(PT), N - 1);
+    loci.erase(std::remove_if(loci.begin(), loci.end(), [this](int n){ return n >= N; }),
+            loci.end());
+    std::ofstream NKTable_csv;
+    NKTable_csv.open("NKTable.csv");
+    if ((int)loci.size() < N) {
+        for (size_t l = 0; l < loci.size(); l++) {
+            NKTable_csv << loci[l] << (l + 1 < loci.size() ? "," : "\n");
+        }
+    }
+    for(int k=0;k<(1<<K);k++){
+        for(size_t l=0;l<loci.size();l++){
+            NKTable_csv << tableEntry(loci[l], PackedBits::reverseBits(k, K)).first;
+            // we don't want commas on the last one
+            if (l + 1 < loci.size()) {
+                NKTable_csv << ",";
+            } else {
+                NKTable_csv << "\n";
+            }
+        }
+    }
+    NKTable_csv.close();
+}
+
+// The table may have been drawn at random, and the fitness cache decides
+// the hit and miss counts in the pop file, so both are saved (a hashed 
+// table only by its seed)
+void NKWorld::saveCheckpoint(Checkpoint::Writer &checkpoint) {
+    checkpoint.put((int32_t)N);
+    checkpoint.put((int32_t)K);
+    checkpoint.put((uint8_t)hash_nk_table);
+    checkpoint.put(hash_nk_table_seed);
+    for (auto const &entry : NKTable) {
+        checkpoint.put(entry.first);
+        checkpoint.put(entry.second);
+    }
+    checkpoint.put((int32_t)fitness_cache_update);
+    checkpoint.put((uint64_t)fitness_cache.size());
+    for (auto const &entry : fitness_cache) {
+        checkpoint.put(entry.first);
+        checkpoint.put(entry.second);
+    }
+}
+
+void NKWorld::loadCheckpoint(Checkpoint::Reader &checkpoint) {
+    int32_t savedN, savedK;
+    checkpoint.get(savedN);
+    checkpoint.get(savedK);
+    if (savedN != N || savedK != K) {
+        std::cout << "  ERROR :: in NKWorld::loadCheckpoint, the checkpoint is for N = "
+                  << savedN << " and K = " << savedK << ", but this world has N = " << N
+                  << " and K = " << K << ". Exiting." << std::endl;
+        exit(1);
+    }
+    uint8_t savedHashed;
+    checkpoint.get(savedHashed);
+    checkpoint.get(hash_nk_table_seed);
+    if ((bool)savedHashed != hash_nk_table) {
+        std::cout << "  ERROR :: in NKWorld::loadCheckpoint, the checkpoint is for a "
+                  << (savedHashed ? "hashed" : "stored") << " NK table, but this world "
+                  << "has WORLD_NK-hashNKTable = " << hash_nk_table << ". Exiting." << std::endl;
+        exit(1);
+    }
+    for (auto &entry : NKTable) {
+        checkpoint.get(entry.first);
+        checkpoint.get(entry.second);
+    }
+    int32_t savedCacheUpdate;
+    checkpoint.get(savedCacheUpdate);
+    fitness_cache_update = savedCacheUpdate;
+    fitness_cache.clear();
+    uint64_t cacheSize = checkpoint.getSize(sizeof(uint64_t));
+    for (uint64_t i = 0; i < cacheSize && checkpoint.ok(); i++) {
+        std::vector<uint64_t> key;
+        double value;
+        checkpoint.get(key);
+        checkpoint.get(value);
+        fitness_cache[key] = value;
+    }
+    setFixedScale();
+    local_values_update = -1;
+    if (writeNKTablePL->get(PT)) {
+        writeNKTableFile();
+    }
+}
+
+// (alpha, beta) of a table entry
+std::pair<double,double> NKWorld::tableEntry(int n, int val) const{
+  if (hash_nk_table) {
+    return {NKKernels::hashedValue(hash_nk_table_seed, n, val, 0), 
+            NKKernels::hashedValue(hash_nk_table_seed, n, val, 1)};
+  }
+  return NKTable[tableIndex(n, val)];
+}
+
+double NKWorld::localValue(int n, int val, double t){
+  std::pair<double,double> entry = tableEntry(n, val);
+  if (treadmill) {
+    // formula for localValue generated by Arend Hintze
+    double alpha = entry.first;   
+    double beta = entry.second;
+    return (1.0 + triangleSin((t*(beta+0.5))+(alpha*PI*2.0)))/2.0;
+  }
+  return entry.first;
+}
+
+// Pick fixed_scale so that no sum or difference of N + 2 local values (in
+// fixed point) can overflow an int64_t. Treadmilling and hashed values are
+// in [0, 1]; static ones are the table's alpha values.
+void NKWorld::setFixedScale(){
+  double max_value = treadmill || hash_nk_table ? 1.0 : 0.0;
+  for (auto const &entry : NKTable) {
+    max_value = std::max(max_value, std::fabs(entry.first));
+  }
+  int exponent;
+  std::frexp(max_value * (N + 2), &exponent); // below 2^exponent
+  fixed_scale = std::ldexp(1.0, 62 - exponent);
+}
+
+// Fill localValues for the current update. A static landscape is only 
+// filled once; a treadmilling one is refilled (in parallel, one row per 
+// task) the first time it is needed in each update. Hashed tables have no 
+// localValues.
+void NKWorld::updateLocalValues(){
+  if (hash_nk_table ||
+      (local_values_update >= 0 && (!treadmill || local_values_update == Global::update))) {
+    return;
+  }
+  double t = Global::update*velocity;
+  evaluation_pool->parallelFor(N, [&](long long n, int thread_id){
+    for (int val = 0; val < (1 << K); val++) {
+      localValues[tableIndex(n, val)] = NKKernels::toFixed(localValue(n, val, t), fixed_scale);
+    }
+  });
+  local_values_update = Global::update;
+  findSparsePatterns();
+}
+
+// Use sparse evaluation if every row of localValues is the same and finding
+// the nonzero patterns costs fewer word operations than N table lookups
+void NKWorld::findSparsePatterns(){
+  bool was_sparse = !sparse_patterns.empty();
+  sparse_patterns.clear();
+  if (!sparse_tables) return;
+  const int64_t* row = &localValues[tableIndex(0, 0)];
+  for (int n = 1; n < N; n++) {
+    if (!std::equal(row, row + (1 << K), &localValues[tableIndex(n, 0)])) return;
+  }
+  for (int val = 0; val < (1 << K); val++) {
+    if (row[val] != 0) sparse_patterns.push_back({val, row[val]});
+  }
+  if (sparse_patterns.empty() || 
+      sparse_patterns.size() * K * PackedBits::wordCount(N) > (size_t)N) {
+    sparse_patterns.clear();
+    return;
+  }
+  if (!was_sparse) {
+    std::cout << "NK table is the same on every row with " << sparse_patterns.size()
+              << " nonzero patterns: using sparse evaluation" << std::endl;
+  }
+}
+
+// Pack the brain's outputs (nonzero = 1) into packed, followed by the first
+// K-1 outputs again. The brain should already be updated.
+void NKWorld::readPacked(std::shared_ptr<AbstractBrain>& brain, uint64_t* packed){
+  std::fill(packed, packed + packed_words, 0);
+  auto constant_brain = dynamic_cast<ConstantValuesBrain*>(brain.get());
+  const std::vector<uint64_t>* values = 
+      constant_brain != nullptr ? constant_brain->getPackedValues() : nullptr;
+  if (values != nullptr) {
+    std::copy(values->begin(), values->begin() + PackedBits::wordCount(N), packed);
+  }
+  else {
+    for (int n=0;n<N;n++) {
+      if ((uint8_t)brain->readOutput(n) > 0) PackedBits::setBit(packed, n, true);
+    }
+  }
+  for (int n=N;n<N+K-1;n++) {
+    PackedBits::setBit(packed, n, PackedBits::getBit(packed, n % N));
+  }
+}
+
+// Score of a packed genome
+double NKWorld::evaluatePacked(const uint64_t* packed){
+  return sparse_patterns.empty() ? evaluateWindows(packed) : evaluateSparse(packed);
+}
+
+// Score of a packed genome, with each window read by a shift
+double NKWorld::evaluateWindows(const uint64_t* packed){
+  return kernels.windows(landscape(), packed);
+}
+
+// Score of a packed genome for a sparse table (see NKKernels::scoreSparse)
+double NKWorld::evaluateSparse(const uint64_t* packed){
+  return kernels.sparse(landscape(), packed);
+}
+
+// Transpose count (up to 64) packed genomes into slices: word b of slices
+// holds bit b of every genome, genome j in bit j. Lanes past count are 0.
+void NKWorld::sliceGenomes(const uint64_t* const* genomes, int count, uint64_t* slices){
+  for (int w = 0; w < packed_words; w++) {
+    uint64_t* block = slices + w * PackedBits::bitsPerWord;
+    for (int j = 0; j < PackedBits::bitsPerWord; j++) {
+      block[j] = j < count ? genomes[j][w] : 0;
+    }
+    PackedBits::transpose64(block);
+  }
+}
+
+// Slices of count mutants of a packed genome: lane j has locus first_locus + j
+// flipped, and every lane also has focal_locus flipped if it is not -1
+void NKWorld::sliceMutants(const uint64_t* packed, int first_locus, int count, 
+        int focal_locus, uint64_t* slices){
+  for (int b = 0; b < N + K - 1; b++) {
+    int locus = b % N;
+    uint64_t slice = PackedBits::getBit(packed, b) ? ~(uint64_t)0 : 0;
+    if (locus >= first_locus && locus < first_locus + count) {
+      slice ^= (uint64_t)1 << (locus - first_locus);
+    }
+    if (locus == focal_locus) {
+      slice = ~slice;
+    }
+    slices[b] = slice;
+  }
+}
+
+// Score count (up to 64) sliced genomes (see NKKernels::scoreSlices)
+void NKWorld::evaluateSlices(const uint64_t* slices, int count, double* scores){
+  kernels.slices(landscape(), slices, count, scores);
+}
+
+// Score the single mutants of a packed genome at loci first_locus to N-1 into
+// scores[locus], with focal_locus also flipped in all of them if it is not -1
+void NKWorld::evaluateMutants(const uint64_t* packed, int focal_locus, int first_locus, 
+        double* scores, int thread_id){
+  uint64_t* slices = thread_slices[thread_id].data();
+  if (!useSlices()) {
+    // flip each locus in a copy of the genome (held in slices), score it and
+    // flip it back
+    uint64_t* mutant = slices;
+    std::copy(packed, packed + packed_words, mutant);
+    if (focal_locus >= 0) flipPacked(mutant, focal_locus);
+    for (int locus = first_locus; locus < N; locus++) {
+      flipPacked(mutant, locus);
+      scores[locus] = evaluatePacked(mutant);
+      flipPacked(mutant, locus);
+    }
+    return;
+  }
+  for (int first = first_locus; first < N; first += PackedBits::bitsPerWord) {
+    int count = std::min(PackedBits::bitsPerWord, N - first);
+    sliceMutants(packed, first, count, focal_locus, slices);
+    evaluateSlices(slices, count, scores + first);
+  }
+}
+
+// Score every window of the packed genome and cache the results in state
+void NKWorld::evaluateDelta(const uint64_t* packed, NKDeltaState& state){
+  state.window_indices.resize(N);
+  state.local_values.resize(N);
+  state.flip_masks.assign(N, 0);
+  state.touched_windows.clear();
+  state.W = 0;
   for (int n=0;n<N;n++) {
-    int val = 0;
-    for (int k=0; k<K; k++) {
-      // convert k adjacent sites to integer for indexing NK table
-      val = (val<<1) + (data[(n+k)%N] > 0.0); 
-    }
-    if (treadmillPL->get(PT)) {
-      // formula for localValue generated by Arend Hintze
-      double alpha = NKTable[n][val].first;   
-      double beta = NKTable[n][val].second;
-      double localValue = (1.0 + triangleSin((t*(beta+0.5))+(alpha*PI*2.0)))/2.0;
-      W += localValue;
-    } else {
-      W += NKTable[n][val].first;
+    int val = PackedBits::readBits(packed, n, K);
+    state.window_indices[n] = val;
+    state.local_values[n] = tableValue(n, val);
+    state.W += state.local_values[n];
+  }
+}
+
+// Flip locus in the cached genome for good, rescoring the windows it is in
+void NKWorld::commitFlip(NKDeltaState& state, int locus){
+  for (auto& window : flipWindows[locus]) {
+    int n = window.first;
+    state.window_indices[n] ^= window.second;
+    int64_t value = tableValue(n, state.window_indices[n]);
+    state.W += value - state.local_values[n];
+    state.local_values[n] = value;
+  }
+}
+
+// Score the cached genome with locus_a (and locus_b, if given) flipped,
+// looking up only the windows that contain a flipped site and adding their
+// differences to W. Local values are in fixed point, so this is exactly the
+// score evaluateWindows gives.
+double NKWorld::evaluateFlips(NKDeltaState& state, int locus_a, int locus_b){
+  for (auto& window : flipWindows[locus_a]) {
+    if (state.flip_masks[window.first] == 0) state.touched_windows.push_back(window.first);
+    state.flip_masks[window.first] ^= window.second;
+  }
+  if (locus_b >= 0) {
+    for (auto& window : flipWindows[locus_b]) {
+      if (state.flip_masks[window.first] == 0) state.touched_windows.push_back(window.first);
+      state.flip_masks[window.first] ^= window.second;
     }
   }
-  double score = W/(double)N;
-  return score;
+  int64_t W = state.W;
+  for (int n : state.touched_windows) {
+    W += tableValue(n, state.window_indices[n] ^ state.flip_masks[n]) - state.local_values[n];
+  }
+  for (int n : state.touched_windows) {
+    state.flip_masks[n] = 0;
+  }
+  state.touched_windows.clear();
+  return NKKernels::score(landscape(), W);
 }
 
 double NKWorld::evaluateBrain(std::shared_ptr<AbstractBrain>& brain){
-    double t = Global::update*(velocityPL->get(PT));
+    std::vector<uint64_t> packed(packed_words, 0);
+    return evaluateBrain(brain, packed);
+}
+
+double NKWorld::evaluateBrain(std::shared_ptr<AbstractBrain>& brain, 
+        std::vector<uint64_t>& packed){
     brain->resetBrain();
     brain->update();
-    std::vector<uint8_t> brain_data(N, 0);
-    for(size_t n = 0; n < N; ++n){
-      brain_data[n] = brain->readOutput(n);
+    readPacked(brain, packed.data());
+    return evaluatePacked(packed.data());
+}
+
+// Make room for incoming new genotypes, emptying the cache if it would 
+// overflow or if the landscape has moved since it was filled
+void NKWorld::prepareFitnessCache(size_t incoming){
+    if ((treadmill && fitness_cache_update != Global::update) ||
+            fitness_cache.size() + incoming > (size_t)fitness_cache_size) {
+        fitness_cache.clear();
     }
-    return evaluateData(brain_data);
+    fitness_cache_update = Global::update;
+}
+
+// Score brain, reusing the score of an earlier brain with the same outputs
+double NKWorld::evaluateCached(std::shared_ptr<AbstractBrain>& brain, 
+        std::vector<uint64_t>& packed){
+    if (fitness_cache_size <= 0) {
+        return evaluateBrain(brain, packed);
+    }
+    brain->resetBrain();
+    brain->update();
+    readPacked(brain, packed.data());
+    prepareFitnessCache(1);
+    auto cached = fitness_cache.find(packed);
+    if (cached != fitness_cache.end()) {
+        fitness_cache_hits++;
+        return cached->second;
+    }
+    fitness_cache_misses++;
+    double score = evaluatePacked(packed.data());
+    fitness_cache.emplace(packed, score);
+    return score;
 }
 
 void NKWorld::evaluateSolo(std::shared_ptr<Organism> org, int analyze,
         int visualize, int debug) {
-    auto brain = org->brains[brainNamePL->get(PT)];
-    for (int r = 0; r < evaluationsPerGenerationPL->get(PT); r++) {
-        double score = evaluateBrain(brain);
+    updateLocalValues();
+    auto brain = org->brains[brain_name];
+    for (int r = 0; r < evaluations_per_generation; r++) {
+        double score = evaluateCached(brain, thread_packed_data[0]);
         org->dataMap.append("score", score);
         if (visualize) {
             std::string filename = "postscore_" + Global::initPopPL->get(PT) + ".csv";
@@ -472,278 +729,532 @@ void NKWorld::evaluateSolo(std::shared_ptr<Organism> org, int analyze,
     }
 }
 
+void NKWorld::evaluate(std::map<std::string, std::shared_ptr<Group>> &groups,
+        int analyze, int visualize, int debug) {
+    auto& population = groups[group_name]->population;
+    updateLocalValues();
+    fitness_cache_hits = 0;
+    fitness_cache_misses = 0;
+    // visualize writes to file per evaluation, so keep it serial. Bit-sliced
+    // evaluation scores the population in blocks, even on one thread.
+    if ((evaluation_pool->size() > 1 || evaluation_method != kScalarEvaluation) && !visualize) {
+        evaluateParallel(population);
+    }
+    else {
+        int popSize = population.size();
+        for (int i = 0; i < popSize; i++) {
+            evaluateSolo(population[i], analyze, visualize, debug);
+        }
+    }
+    // Counted before the recorders run, which look up their mutants in the
+    // cache too, so the counts do not depend on the output intervals. They
+    // belong to the run, so they go in the pop file only.
+    if (fitness_cache_size > 0) {
+        DataMap& stats = groups[group_name]->archivist->popFileStats;
+        stats.set("fitnessCacheHits", fitness_cache_hits);
+        stats.set("fitnessCacheMisses", fitness_cache_misses);
+    }
+    if(output_rank_epistasis && Global::update % output_rank_epistasis_interval == 0)
+        recordRankEpistasis(groups);
+    if(output_mutant_fitness && Global::update % output_mutant_fitness_interval == 0)
+        recordMutantFitness(groups);
+    if(output_landscape && Global::update % output_landscape_interval == 0)
+        recordLandscape();
+}
+
+// Read every organism's outputs in contiguous blocks, one per thread, look 
+// each genotype up in the cache, score the missing genotypes (each once) in 
+// parallel, then append the scores to each organism's dataMap in population 
+// order
+void NKWorld::evaluateParallel(std::vector<std::shared_ptr<Organism>>& population){
+    int popSize = population.size();
+    int numThreads = evaluation_pool->size();
+    size_t num_evaluations = (size_t)popSize * evaluations_per_generation;
+    std::vector<std::shared_ptr<AbstractBrain>> brains(popSize);
+    for (int i = 0; i < popSize; i++) {
+        brains[i] = population[i]->brains[brain_name];
+    }
+    population_packed.resize(num_evaluations * packed_words);
+    evaluation_pool->run([&](int thread_id){
+        int block_start = (int)((long long)popSize * thread_id / numThreads);
+        int block_end = (int)((long long)popSize * (thread_id + 1) / numThreads);
+        for (int i = block_start; i < block_end; i++) {
+            for (int r = 0; r < evaluations_per_generation; r++) {
+                brains[i]->resetBrain();
+                brains[i]->update();
+                readPacked(brains[i], 
+                        &population_packed[(i * evaluations_per_generation + r) * packed_words]);
+            }
+        }
+    });
+    population_scores.resize(num_evaluations);
+    evaluation_values.resize(num_evaluations);
+    pending_evaluations.clear();
+    if (fitness_cache_size > 0) {
+        // Entries for new genotypes are added now and filled in below, so 
+        // a genotype seen twice in this population is only scored once
+        prepareFitnessCache(num_evaluations);
+        std::vector<uint64_t>& key = thread_packed_data[0];
+        for (size_t e = 0; e < num_evaluations; e++) {
+            key.assign(population_packed.begin() + e * packed_words, 
+                    population_packed.begin() + (e + 1) * packed_words);
+            auto cached = fitness_cache.find(key);
+            if (cached != fitness_cache.end()) {
+                fitness_cache_hits++;
+            }
+            else {
+                fitness_cache_misses++;
+                cached = fitness_cache.emplace(key, 0.0).first;
+                pending_evaluations.push_back(e);
+            }
+            evaluation_values[e] = &cached->second;
+        }
+    }
+    else {
+        for (size_t e = 0; e < num_evaluations; e++) {
+            evaluation_values[e] = &population_scores[e];
+            pending_evaluations.push_back(e);
+        }
+    }
+    if (!useSlices()) {
+        evaluation_pool->parallelFor(pending_evaluations.size(), [&](long long p, int thread_id){
+            size_t e = pending_evaluations[p];
+            *evaluation_values[e] = evaluatePacked(&population_packed[e * packed_words]);
+        });
+    }
+    else {
+        // one task per block of 64 pending evaluations
+        long long num_blocks = (pending_evaluations.size() + PackedBits::bitsPerWord - 1) 
+                / PackedBits::bitsPerWord;
+        evaluation_pool->parallelFor(num_blocks, [&](long long block, int thread_id){
+            size_t first = (size_t)block * PackedBits::bitsPerWord;
+            int count = (int)std::min((size_t)PackedBits::bitsPerWord, 
+                    pending_evaluations.size() - first);
+            const uint64_t* genomes[PackedBits::bitsPerWord];
+            for (int j = 0; j < count; j++) {
+                genomes[j] = &population_packed[pending_evaluations[first + j] * packed_words];
+            }
+            uint64_t* slices = thread_slices[thread_id].data();
+            double* scores = thread_slice_scores[thread_id].data();
+            sliceGenomes(genomes, count, slices);
+            evaluateSlices(slices, count, scores);
+            for (int j = 0; j < count; j++) {
+                *evaluation_values[pending_evaluations[first + j]] = scores[j];
+            }
+        });
+    }
+    if (evaluation_method == kBitSlicedRegression) {
+        // checked against the generic kernel, so the kernels specialized for
+        // K are checked too
+        std::string method = sparse_patterns.empty() ? "bit-sliced" : "sparse";
+        size_t num_mismatches = 0;
+        for (size_t e : pending_evaluations) {
+            double score = NKKernels::select(0, hash_nk_table).windows(landscape(), 
+                    &population_packed[e * packed_words]);
+            if (score != *evaluation_values[e]) {
+                std::cerr << "Fast score mismatch! update: " << Global::update
+                          << " evaluation: " << e << " " << method << ": " 
+                          << *evaluation_values[e] << " scalar: " << score << std::endl;
+                ++num_mismatches;
+            }
+        }
+        if (num_mismatches > 0) {
+            std::cerr << "ERROR! " << method << " evaluation differs from scalar evaluation in " 
+                      << num_mismatches << " scores!" << std::endl;
+            exit(-1);
+        }
+    }
+    for (size_t e = 0; e < num_evaluations; e++) {
+        population_scores[e] = *evaluation_values[e];
+    }
+    for (int i = 0; i < popSize; i++) {
+        for (int r = 0; r < evaluations_per_generation; r++) {
+            population[i]->dataMap.append("score", 
+                    population_scores[i * evaluations_per_generation + r]);
+        }
+    }
+}
+
+// Rank the mutants by their original (focal locus not mutated) scores and
+// compare against their order once the focal locus is also mutated, with a
+// Wilcoxon signed rank-sum (https://en.wikipedia.org/wiki/Wilcoxon_signed-rank_test).
+// order must hold the mutants in Ranking::stableOrder of score_original; it 
+// is reordered by score_mutant. Ties in score_mutant keep their original order.
+WilcoxResult RankMutants(const std::vector<double>& score_original, 
+        const std::vector<double>& score_mutant, std::vector<size_t>& order,
+        double tie_tolerance, RankEpistasisScratch& scratch){
+  Ranking::midRanks(score_original, order, tie_tolerance, scratch.ranks);
+  // Ranks are kept as whole numbers (mid-ranks rounded down)
+  for (size_t i = 0; i < order.size(); i++) {
+      scratch.rank_vec_original[i] = scratch.ranks[order[i]];
+  }
+  Ranking::reorder(score_mutant, order);
+  for (size_t i = 0; i < order.size(); i++) {
+      scratch.rank_vec_mutated[i] = scratch.ranks[order[i]];
+  }
+  return Ranking::signedRankSum(scratch.rank_vec_original, scratch.rank_vec_mutated,
+          scratch.rank_counts); 
+}
+
 void NKWorld::recordRankEpistasis(std::map<std::string, std::shared_ptr<Group>> &groups){
         std::cout << "Recording edit distance..." << std::endl;
         output_string_stream.str("");
         // Fetch the population size for easy use
-        int popSize = groups[groupNamePL->get(PT)]->population.size();
-        // TODO: Cache genotypes we have seen before!
-        std::unordered_map<std::string, double> genotype_fitness_map;
-        // Create a vector to be used for easier organism evaluation 
-        std::vector<uint8_t> brain_data(N, 0);
-        //std::cout << std::endl << std::endl;
-        //std::cout << "update,org_idx,focal_locus_idx,mut_locus_idx,fitness_one_mut,fitness_two_mut" 
-        //  << std::endl;
-        // Calculate the edit distance metric on *each* organism in the population
+        auto& population = groups[group_name]->population;
+        int popSize = population.size();
+        updateLocalValues();
+        // Read every organism's brain outputs up front, so the worker threads 
+        // never touch the organisms themselves. Organisms sharing a genotype 
+        // share the results of the first one, which is the only one scanned.
+        std::unordered_map<std::vector<uint64_t>, int, PackedGenomeHash> genotype_orgs;
+        std::vector<int> scanned_org_idx(popSize);
+        std::vector<int> scan_orgs;
+        population_packed.resize((size_t)popSize * packed_words);
         for(size_t org_idx = 0; org_idx < popSize; org_idx++) {
-          auto org = groups[groupNamePL->get(PT)]->population[org_idx]->makeCopy(); 
-          auto brain = org->brains[brainNamePL->get(PT)];
+          auto brain = population[org_idx]->brains[brain_name];
           brain->resetBrain();
           brain->update();
-          for(size_t n = 0; n < N; ++n){
-            brain_data[n] = brain->readOutput(n);
-          }
-          for(size_t focal_locus_idx = 0; focal_locus_idx < N; ++focal_locus_idx){
-            for(size_t mut_locus_idx = 0; mut_locus_idx < N; ++mut_locus_idx){
-              mutant_data_vec[mut_locus_idx].offset = (mut_locus_idx - focal_locus_idx + N) % N; 
-              if(mut_locus_idx == focal_locus_idx){
-                mutant_data_vec[mut_locus_idx].score_original = 0;
-                mutant_data_vec[mut_locus_idx].score_mutant = 0;
-              }
-              else{
-                brain_data[mut_locus_idx] ^= 1;
-                mutant_data_vec[mut_locus_idx].score_original = evaluateData(brain_data);
-                brain_data[focal_locus_idx] ^= 1;
-                mutant_data_vec[mut_locus_idx].score_mutant = evaluateData(brain_data);
-                brain_data[mut_locus_idx] ^= 1;
-                brain_data[focal_locus_idx] ^= 1;
-                //std::cout << 
-                //  Global::update << "," <<
-                //  org_idx << "," <<
-                //  focal_locus_idx << "," <<
-                //  mut_locus_idx << "," <<
-                //  mutant_data_vec[mut_locus_idx].score_original << "," <<
-                //  mutant_data_vec[mut_locus_idx].score_mutant << std::endl;
-              }
-            }
-          //// Sort based on offset
-          //std::stable_sort(mutant_data_vec.begin(), mutant_data_vec.end(), 
-          //    [](const RankEpistasisData& a, const RankEpistasisData& b){
-          //   return a.offset < b.offset; 
-          //});
-          // Sort based on original (focal locus not mutated) order
-          std::stable_sort(mutant_data_vec.begin(), mutant_data_vec.end(), 
-              [](const RankEpistasisData& a, const RankEpistasisData& b){
-             return a.score_original < b.score_original; 
-          });
-          // Rank the orgs based on their original scores
-          size_t rank = 0;     // Current rank to be assigned
-          size_t rank_idx = 0; // Current index to assign a rank to
-          size_t offset = 0;   // How many scores (this + following) have the same score?
-          // Repeated scores should have the same rank
-          // This rank is the midpoint of the ranks if they were sequential
-          // e.g. (from Wikipedia) scores = 3,5,5,5,5,8 => ranks 1,3.5,3.5,3.5,3.5,6
-          while(rank_idx < mutant_data_vec.size()){
-            offset = 1;
-            while(true){
-              // If the next number is not the same, stop! (also stop if we run off the end)
-              //if(rank_idx + offset >= mutant_data_vec.size()){
-              if(rank_idx + offset >= mutant_data_vec.size() || 
-                  mutant_data_vec[rank_idx + offset].score_original < 
-                  mutant_data_vec[rank_idx].score_original - 0.0001 || 
-                  mutant_data_vec[rank_idx + offset].score_original > 
-                  mutant_data_vec[rank_idx].score_original + 0.0001)  {
-                break;
+          readPacked(brain, &population_packed[org_idx * packed_words]);
+          auto genotype = genotype_orgs.emplace(std::vector<uint64_t>(
+                  population_packed.begin() + org_idx * packed_words, 
+                  population_packed.begin() + (org_idx + 1) * packed_words), org_idx);
+          if(genotype.second)
+            scan_orgs.push_back(org_idx);
+          scanned_org_idx[org_idx] = genotype.first->second;
+        }
+        for(auto& scratch : rank_epistasis_scratch){
+          scratch.cached_org_idx = -1;
+        }
+        // Each (scanned organism, focal locus) pair is one task, and its result 
+        // goes in a fixed slot so rows come out in the same order as a serial run 
+        rank_epistasis_results.resize((size_t)popSize * N);
+        if(rank_epistasis_evaluation == kRegression)
+          rank_epistasis_results_full.resize((size_t)popSize * N);
+        evaluation_pool->parallelFor((long long)scan_orgs.size() * N, [&](long long scan_task_idx, int thread_id){
+          RankEpistasisScratch& scratch = rank_epistasis_scratch[thread_id];
+          int org_idx = scan_orgs[scan_task_idx / N];
+          size_t focal_locus_idx = scan_task_idx % N;
+          size_t task_idx = (size_t)org_idx * N + focal_locus_idx;
+          const uint64_t* packed = &population_packed[(size_t)org_idx * packed_words];
+          if(scratch.cached_org_idx != org_idx){
+            // Cache the unmutated windows; each mutant then only rescores the 
+            // windows containing its flipped sites
+            if(rank_epistasis_evaluation != kFullReevaluation){
+              evaluateDelta(packed, scratch.delta_state);
+              for(size_t mut_locus_idx = 0; mut_locus_idx < N; ++mut_locus_idx){
+                scratch.single_scores[mut_locus_idx] = 
+                    evaluateFlips(scratch.delta_state, mut_locus_idx);
               }
-              ++offset;
+              Ranking::stableOrder(scratch.single_scores, scratch.single_order);
             }
-            // Find the midpoint, and put it in each slot with the same score
-            for(size_t tmp_offset = 0; tmp_offset < offset; ++tmp_offset){
-              // Equivalent to ((rank + 1) + (rank + offset)) / 2
-              mutant_data_vec[rank_idx + tmp_offset].rank = (2.0 * rank + offset + 1) / 2.0 ;
+            if(rank_epistasis_evaluation != kIncremental){
+              evaluateMutants(packed, -1, 0, scratch.single_scores_full.data(), thread_id);
+              Ranking::stableOrder(scratch.single_scores_full, scratch.single_order_full);
             }
-            rank_idx += offset;
-            rank += offset;
+            scratch.cached_org_idx = org_idx;
           }
-          //// Assign ranks [0,N)
-          //for(size_t rank_id = 0; rank_id < N; ++rank_id)
-          //  mutant_data_vec[rank_id].rank = rank_id;
-          // Sort orgs again, this time based on the mutated (focal locus mutated) score 
-          // Grab all the ranks in a vector
-          for (int i = 0; i < N; i++) {
-              rank_vec_original[i] = mutant_data_vec[i].rank;
+          // The focal locus itself is left out by scoring it 0 both ways
+          if(rank_epistasis_evaluation != kFullReevaluation){
+            scratch.score_original = scratch.single_scores;
+            scratch.score_original[focal_locus_idx] = 0;
+            for(size_t mut_locus_idx = 0; mut_locus_idx < N; ++mut_locus_idx){
+              scratch.score_mutant[mut_locus_idx] = (mut_locus_idx == focal_locus_idx) ? 0 :
+                  evaluateFlips(scratch.delta_state, mut_locus_idx, focal_locus_idx);
+            }
+            Ranking::moveInOrder(scratch.score_original, scratch.single_order, 
+                focal_locus_idx, scratch.order);
+            rank_epistasis_results[task_idx] = RankMutants(scratch.score_original, 
+                scratch.score_mutant, scratch.order, rank_tie_tolerance, scratch);
           }
-          std::stable_sort(mutant_data_vec.begin(), mutant_data_vec.end(), 
-              [](const RankEpistasisData& a, const RankEpistasisData& b){
-             return a.score_mutant < b.score_mutant; 
-          });
-          // Grab all the ranks in a vector
-          for (int i = 0; i < N; i++) {
-              rank_vec_mutated[i] = mutant_data_vec[i].rank;
+          if(rank_epistasis_evaluation != kIncremental){
+            scratch.score_original_full = scratch.single_scores_full;
+            scratch.score_original_full[focal_locus_idx] = 0;
+            evaluateMutants(packed, focal_locus_idx, 0, scratch.score_mutant_full.data(), thread_id);
+            scratch.score_mutant_full[focal_locus_idx] = 0;
+            Ranking::moveInOrder(scratch.score_original_full, scratch.single_order_full, 
+                focal_locus_idx, scratch.order);
+            WilcoxResult result = RankMutants(scratch.score_original_full, 
+                scratch.score_mutant_full, scratch.order, rank_tie_tolerance, scratch);
+            if(rank_epistasis_evaluation == kFullReevaluation)
+              rank_epistasis_results[task_idx] = result;
+            else
+              rank_epistasis_results_full[task_idx] = result;
           }
-          
-          //// Calculate edit distance and add line to output
-          //double edit_distance = Wilcoxon_U(mutant_data_vec); 
-          WilcoxResult wilcox_res = Wilcoxon_W(rank_vec_original, rank_vec_mutated); 
-          //WilcoxResult wilcox_res{0,0};
-          //double edit_distance = EditDistance(rank_vec_original, rank_vec_mutated, 
-          
-          output_string_stream << Global::update 
-                               << ","
-                               << org_idx
-                               << ","
-                               << focal_locus_idx
-                               << ","
-                               << wilcox_res.W
-                               << ","
-                               << wilcox_res.N_r
-                               << std::endl;
+        });
+        size_t num_mismatches = 0;
+        for(size_t org_idx = 0; org_idx < popSize; org_idx++) {
+          for(size_t focal_locus_idx = 0; focal_locus_idx < N; ++focal_locus_idx){
+            size_t result_idx = (size_t)scanned_org_idx[org_idx] * N + focal_locus_idx;
+            const WilcoxResult& wilcox_res = rank_epistasis_results[result_idx];
+            if(rank_epistasis_evaluation == kRegression){
+              const WilcoxResult& wilcox_res_full = rank_epistasis_results_full[result_idx];
+              if(wilcox_res.W != wilcox_res_full.W || wilcox_res.N_r != wilcox_res_full.N_r){
+                std::cerr << "Rank epistasis mismatch! update: " << Global::update
+                          << " org_idx: " << org_idx 
+                          << " locus_idx: " << focal_locus_idx
+                          << " incremental (W, N_r): (" << wilcox_res.W << ", " 
+                          << wilcox_res.N_r << ")"
+                          << " full (W, N_r): (" << wilcox_res_full.W << ", " 
+                          << wilcox_res_full.N_r << ")" << std::endl;
+                ++num_mismatches;
+              }
+            }
+            output_string_stream << Global::update 
+                                 << ","
+                                 << org_idx
+                                 << ","
+                                 << focal_locus_idx
+                                 << ","
+                                 << wilcox_res.W
+                                 << ","
+                                 << wilcox_res.N_r
+                                 << std::endl;
           }
         }
+        if(num_mismatches > 0){
+            std::cerr << "ERROR! Incremental rank epistasis differs from full re-evaluation in " 
+                      << num_mismatches << " rows!" << std::endl;
+            exit(-1);
+        }
         FileManager::writeToFile(output_rank_epistasis_filename, output_string_stream.str(), 
             "update,org_idx,locus_idx,W,N_r");
     }
 
+// Genotypes are numbered with locus n in bit n. Enumeration walks them in 
+// Gray code order (the i-th genotype is i ^ (i >> 1)), so each step flips a 
+// single locus, the lowest set bit of i, and only the windows containing it 
+// are rescored. The walk is cut into 2^prefix_bits chunks of consecutive i; 
+// within a chunk only the low loci change, so each chunk starts from a freshly
+// scored genotype and chunks run in parallel. Chunk results are merged in
+// chunk order, so the output does not depend on the number of threads.
+// With rankEpistasisEvaluation = 2, every genotype is also scored with full
+// re-evaluation of its mutants, and any difference is an error.
+void NKWorld::recordLandscape(){
+  std::cout << "Enumerating landscape..." << std::endl;
+  updateLocalValues();
+  const int prefix_bits = std::min(N, 10);
+  const int walk_bits = N - prefix_bits;
+  const uint64_t num_chunks = (uint64_t)1 << prefix_bits;
+  std::vector<LandscapeSummary> chunk_summaries(num_chunks);
+  evaluation_pool->parallelFor(num_chunks, [&](long long chunk, int thread_id){
+    RankEpistasisScratch& scratch = rank_epistasis_scratch[thread_id];
+    NKDeltaState& state = scratch.delta_state;
+    LandscapeSummary& summary = chunk_summaries[chunk];
+    summary = LandscapeSummary();
+    uint64_t* packed = thread_packed_data[thread_id].data();
+    uint64_t first = (uint64_t)chunk << walk_bits;
+    uint64_t genotype = first ^ (first >> 1);
+    bool check = rank_epistasis_evaluation == kRegression;
+    packGenotype(genotype, packed);
+    evaluateDelta(packed, state);
+    for (uint64_t i = first; i < first + ((uint64_t)1 << walk_bits); i++) {
+      if (i != first) {
+        int locus = PackedBits::lowestBit(i);
+        genotype ^= (uint64_t)1 << locus;
+        commitFlip(state, locus);
+        if (check) flipPacked(packed, locus);
+      }
+      double score = NKKernels::score(landscape(), state.W);
+      summary.sum_score += score;
+      if (summary.genotypes == 0 || score > summary.max_score) {
+        summary.max_score = score;
+        summary.max_genotype = genotype;
+      }
+      summary.genotypes++;
+      bool fitter_mutant = false;
+      bool equal_mutant = false;
+      for (int locus = 0; locus < N; locus++) {
+        double mutant_score = evaluateFlips(state, locus);
+        scratch.single_scores[locus] = mutant_score;
+        fitter_mutant = fitter_mutant || mutant_score > score;
+        equal_mutant = equal_mutant || mutant_score == score;
+      }
+      if (!fitter_mutant) {
+        summary.local_optima++;
+        if (!equal_mutant) summary.strict_local_optima++;
+      }
+      bool mismatch = false;
+      if (check) {
+        evaluateMutants(packed, -1, 0, scratch.single_scores_full.data(), thread_id);
+        mismatch = score != evaluatePacked(packed) || 
+            scratch.single_scores != scratch.single_scores_full;
+      }
+      if (landscape_rank_epistasis) {
+        // rank epistasis at every focal locus, as in recordRankEpistasis
+        Ranking::stableOrder(scratch.single_scores, scratch.single_order);
+        for (int focal_locus = 0; focal_locus < N; focal_locus++) {
+          scratch.score_original = scratch.single_scores;
+          scratch.score_original[focal_locus] = 0;
+          for (int locus = 0; locus < N; locus++) {
+            scratch.score_mutant[locus] = (locus == focal_locus) ? 0 :
+                evaluateFlips(state, locus, focal_locus);
+          }
+          Ranking::moveInOrder(scratch.score_original, scratch.single_order, 
+              focal_locus, scratch.order);
+          WilcoxResult result = RankMutants(scratch.score_original, scratch.score_mutant, 
+              scratch.order, rank_tie_tolerance, scratch);
+          summary.rank_epistasis_pairs++;
+          summary.sum_W += result.W;
+          summary.sum_abs_W += std::fabs(result.W);
+          summary.sum_N_r += result.N_r;
+          if (result.N_r > 0) summary.changed_pairs++;
+          if (!check) continue;
+          scratch.score_original_full = scratch.single_scores_full;
+          scratch.score_original_full[focal_locus] = 0;
+          evaluateMutants(packed, focal_locus, 0, scratch.score_mutant_full.data(), thread_id);
+          scratch.score_mutant_full[focal_locus] = 0;
+          // the single mutant scores matched, so their order is reused
+          Ranking::moveInOrder(scratch.score_original_full, scratch.single_order, 
+              focal_locus, scratch.order);
+          WilcoxResult result_full = RankMutants(scratch.score_original_full, 
+              scratch.score_mutant_full, scratch.order, rank_tie_tolerance, scratch);
+          mismatch = mismatch || result.W != result_full.W || result.N_r != result_full.N_r;
+        }
+      }
+      if (mismatch) summary.mismatches++;
+    }
+  });
+  for (auto& scratch : rank_epistasis_scratch) {
+    scratch.cached_org_idx = -1;
+  }
+  LandscapeSummary total;
+  for (auto& summary : chunk_summaries) {
+    if (total.genotypes == 0 || summary.max_score > total.max_score) {
+      total.max_score = summary.max_score;
+      total.max_genotype = summary.max_genotype;
+    }
+    total.genotypes += summary.genotypes;
+    total.sum_score += summary.sum_score;
+    total.local_optima += summary.local_optima;
+    total.strict_local_optima += summary.strict_local_optima;
+    total.rank_epistasis_pairs += summary.rank_epistasis_pairs;
+    total.sum_W += summary.sum_W;
+    total.sum_abs_W += summary.sum_abs_W;
+    total.sum_N_r += summary.sum_N_r;
+    total.changed_pairs += summary.changed_pairs;
+    total.mismatches += summary.mismatches;
+  }
+  if (total.mismatches > 0) {
+    std::cerr << "ERROR! Landscape scores or rank epistasis differ from full "
+              << "re-evaluation for " << total.mismatches << " genotypes!" << std::endl;
+    exit(-1);
+  }
+  std::string max_genotype;
+  for (int n = 0; n < N; n++) {
+    max_genotype += ((total.max_genotype >> n) & 1) ? '1' : '0';
+  }
+  double pairs = std::max<uint64_t>(total.rank_epistasis_pairs, 1);
+  output_string_stream.str("");
+  output_string_stream << Global::update << ","
+                       << total.genotypes << ","
+                       << total.sum_score / total.genotypes << ","
+                       << total.max_score << ","
+                       << max_genotype << ","
+                       << total.local_optima << ","
+                       << total.strict_local_optima << ","
+                       << total.rank_epistasis_pairs << ","
+                       << total.sum_W / pairs << ","
+                       << total.sum_abs_W / pairs << ","
+                       << total.sum_N_r / pairs << ","
+                       << total.changed_pairs / pairs
+                       << std::endl;
+  FileManager::writeToFile(output_landscape_filename, output_string_stream.str(), 
+      "update,genotypes,score_avg,score_max,genotype_max,local_optima,strict_local_optima,"
+      "rank_epistasis_pairs,W_avg,abs_W_avg,N_r_avg,changed_fraction");
+}
+
+// Packed genome of a genotype numbered with locus n in bit n
+void NKWorld::packGenotype(uint64_t genotype, uint64_t* packed){
+  std::fill(packed, packed + packed_words, 0);
+  for (int n = 0; n < N + K - 1; n++) {
+    if ((genotype >> (n % N)) & 1) PackedBits::setBit(packed, n, true);
+  }
+}
+
+// Flip locus in a packed genome, along with its copy past the end
+void NKWorld::flipPacked(uint64_t* packed, int locus){
+    for (int bit = locus; bit < N + K - 1; bit += N) {
+        PackedBits::flipBit(packed, bit);
+    }
+}
+
+// Score every one and two site mutant of a packed genome
+MutantFitnessSummary NKWorld::summarizeMutants(std::vector<uint64_t>& packed, 
+        double score_original){
+    MutantFitnessSummary summary;
+    summary.score_original = score_original;
+    summary.avg_1 = 0;
+    summary.max_1 = 0;
+    summary.min_1 = 1000000;
+    summary.avg_2 = 0;
+    summary.max_2 = 0;
+    summary.min_2 = 1000000;
+    double score = 0;
+    single_mutant_scores.resize(N);
+    double_mutant_scores.resize(N);
+    evaluateMutants(packed.data(), -1, 0, single_mutant_scores.data(), 0);
+    for(int j = 0; j < N; ++j){
+        score = single_mutant_scores[j];
+        summary.avg_1 += (score / N);
+        if(j == 0 || score > summary.max_1)
+            summary.max_1 = score;
+        if(j == 0 || score < summary.min_1)
+            summary.min_1 = score;
+        evaluateMutants(packed.data(), j, j + 1, double_mutant_scores.data(), 0);
+        for(int k = j + 1; k < N; ++k){
+            score = double_mutant_scores[k];
+            summary.avg_2 += (score / (N * (N - 1) / 2));
+            bool first_double_mutant = (j == 0 && k == 1);
+            if(first_double_mutant || score > summary.max_2)
+                summary.max_2 = score;
+            if(first_double_mutant || score < summary.min_2)
+                summary.min_2 = score;
+        }
+    }
+    return summary;
+}
+
 void NKWorld::recordMutantFitness(std::map<std::string, std::shared_ptr<Group>> &groups){
         std::cout << "Recording mutant fitness..." << std::endl;
         output_string_stream.str("");
-        int pop_size = groups[groupNamePL->get(PT)]->population.size();
-        double score_original = 0;
-        double score_running_avg_0 = 0;
-        double score_max_0 = 0;
-        double score_min_0 = 1000000;
-        double score = 0;
-        double score_running_avg_1 = 0;
-        double score_max_1 = 0;
-        double score_min_1 = 1000000;
-        double score_running_avg_2 = 0;
-        double score_max_2 = 0;
-        double score_min_2 = 1000000;
+        updateLocalValues();
+        auto& population = groups[group_name]->population;
+        int pop_size = population.size();
+        // Organisms with the same genotype share one summary
+        std::unordered_map<std::vector<uint64_t>, MutantFitnessSummary, PackedGenomeHash> 
+            genotype_summaries;
+        std::vector<uint64_t>& packed = thread_packed_data[0];
         for (int i = 0; i < pop_size; i++) {
-            score_original = 0;
-            score_running_avg_0 = 0;
-            score_max_0 = 0;
-            score_min_0 = 1000000;
-            score = 0;
-            score_running_avg_1 = 0;
-            score_max_1 = 0;
-            score_min_1 = 1000000;
-            score_running_avg_2 = 0;
-            score_max_2 = 0;
-            score_min_2 = 1000000;
-            // Get organism, evaluate it, cache score
-            auto org_copy = groups[groupNamePL->get(PT)]->population[i]->makeCopy(); 
-            evaluateSolo(org_copy, 0, 0, 0); 
-            score = org_copy->dataMap.getAverage("score");
-            score_original = score;
-            score_running_avg_0 += (score / pop_size);
-            if(i == 0){
-                score_max_0 = score;
-                score_min_0 = score;
-            }
-            else{
-                if(score > score_max_0)
-                    score_max_0 = score;
-                if(score < score_min_0)
-                    score_min_0 = score;
-            }
-            // Do one step mutations to this organism
-            for(size_t j = 0; j < N; ++j){
-                std::shared_ptr<AbstractGenome> g = org_copy->genomes["root::"];
-                std::shared_ptr<CircularGenome<bool>::Handler> genome_original = 
-                    std::dynamic_pointer_cast<CircularGenome<bool>::Handler>(
-                        g->newHandler(g));
-                CircularGenome<bool> tmp_mutant_genome(2, N, PT);
-                std::shared_ptr<AbstractGenome> tmp_mutant_genome_ptr = 
-                    std::make_shared<CircularGenome<bool>>(tmp_mutant_genome);
-                std::shared_ptr<CircularGenome<bool>::Handler> genome_mutant = 
-                    std::dynamic_pointer_cast<CircularGenome<bool>::Handler>(
-                        tmp_mutant_genome_ptr->newHandler(tmp_mutant_genome_ptr));
-                genome_mutant->resetHandler();
-                int read_val = 0;
-                for(size_t site_idx=0; site_idx < genome_original->genome->countSites();++site_idx){
-                    read_val = genome_original->readInt(0,1);
-                    if(site_idx == j){
-                       genome_mutant->writeInt((read_val + 1) & 1, 0, 1);
-                    }
-                    else{
-                       genome_mutant->writeInt(read_val, 0, 1);
-                    }
-                }
-            
-                //// Reevaluate organism after mutation
-                org_copy->dataMap.clear("score");
-                org_copy->genomes["root::"] = genome_mutant->genome;
-                org_copy->brains["root::"] = 
-                    std::dynamic_pointer_cast<ConstantValuesBrain>(org_copy->brains["root::"])
-                        ->makeBrain(org_copy->genomes);
-                evaluateSolo(org_copy, 0, 0, 0); 
-                score = org_copy->dataMap.getAverage("score");
-                score_running_avg_1 += (score / N);
-                if(i == 0 && j == 0){
-                    score_max_1 = score;
-                    score_min_1 = score;
-                }
-                else{
-                    if(score > score_max_1)
-                        score_max_1 = score;
-                    if(score < score_min_1)
-                        score_min_1 = score;
-                }
-                // Do two step mutations on this organism
-                for(size_t k = j + 1; k < N; ++k){
-                    CircularGenome<bool> tmp_mutant_genome_2(2, N, PT);
-                    std::shared_ptr<AbstractGenome> tmp_mutant_genome_ptr_2 = 
-                        std::make_shared<CircularGenome<bool>>(tmp_mutant_genome_2);
-                    std::shared_ptr<CircularGenome<bool>::Handler> genome_mutant_2 = 
-                        std::dynamic_pointer_cast<CircularGenome<bool>::Handler>(
-                            tmp_mutant_genome_ptr_2->newHandler(tmp_mutant_genome_ptr_2));
-                    genome_mutant_2->resetHandler();
-                    read_val = 0;
-                    for(size_t site_idx=0; site_idx < genome_original->genome->countSites();++site_idx){
-                        read_val = genome_original->readInt(0,1);
-                        if(site_idx == j || site_idx == k){
-                           genome_mutant_2->writeInt((read_val + 1) & 1, 0, 1);
-                        }
-                        else{
-                           genome_mutant_2->writeInt(read_val, 0, 1);
-                        }
-                    }
-                
-                    //// Reevaluate organism after mutation
-                    org_copy->dataMap.clear("score");
-                    org_copy->genomes["root::"] = genome_mutant_2->genome;
-                    org_copy->brains["root::"] = 
-                        std::dynamic_pointer_cast<ConstantValuesBrain>(org_copy->brains["root::"])
-                            ->makeBrain(org_copy->genomes);
-                    evaluateSolo(org_copy, 0, 0, 0); 
-                    score = org_copy->dataMap.getAverage("score");
-                    score_running_avg_2 += (score / (N * (N - 1) / 2));
-                    if(i == 0 && j == 0){
-                        score_max_2 = score;
-                        score_min_2 = score;
-                    }
-                    else{
-                        if(score > score_max_2)
-                            score_max_2 = score;
-                        if(score < score_min_2)
-                            score_min_2 = score;
-                    }
-                }
+            // Get organism's genotype and score, then score its mutants
+            double score_original = evaluateCached(population[i]->brains[brain_name], packed);
+            auto summary = genotype_summaries.find(packed);
+            if(summary == genotype_summaries.end()){
+                MutantFitnessSummary new_summary = summarizeMutants(packed, score_original);
+                summary = genotype_summaries.emplace(packed, new_summary).first;
             }
             output_string_stream 
                 << Global::update << ","
                 << i << ","
                 << "0" << "," 
-                << score_original << "," 
-                << score_original << "," 
-                << score_original
+                << summary->second.score_original << "," 
+                << summary->second.score_original << "," 
+                << summary->second.score_original
                 << std::endl;
             output_string_stream 
                 << Global::update << ","
                 << i << ","
                 << "1" << "," 
-                << score_running_avg_1 << "," 
-                << score_max_1 << "," 
-                << score_min_1
+                << summary->second.avg_1 << "," 
+                << summary->second.max_1 << "," 
+                << summary->second.min_1
                 << std::endl;
             output_string_stream 
                 << Global::update << ","
                 << i << ","
                 << "2" << "," 
-                << score_running_avg_2 << "," 
-                << score_max_2 << "," 
-                << score_min_2 
+                << summary->second.avg_2 << "," 
+                << summary->second.max_2 << "," 
+                << summary->second.min_2 
                 << std::endl;
         }
         FileManager::writeToFile(output_mutant_fitness_filename, output_string_stream.str(), 
@@ -10,6 +10,11 @@
 #pragma once
 
 #include "../AbstractWorld.h"
+#include "NKKernels.h"
+#include "../../Utilities/AlignedAllocator.h"
+#include "../../Utilities/PackedBits.h"
+#include "../../Utilities/Ranking.h"
+#include "../../Utilities/ThreadPool.h"
 
 #include <cstdlib>
 #include <thread>
@@ -18,12 +23,88 @@
 #include <iomanip>
 #include <string>
 #include <algorithm>
+#include <unordered_map>
 
-struct RankEpistasisData{
-    size_t offset;
-    double rank;
+// Cached per-locus state of an unmutated genome, used to score bit flips
+// by recomputing only the windows the flipped sites fall into
+struct NKDeltaState{
+    std::vector<int> window_indices; // K-bit table index of each window (first site lowest)
+    std::vector<int64_t> local_values; // table value of each window, in fixed point
+    int64_t W; // sum of local_values
+    std::vector<int> flip_masks; // scratch, pending index flips per window
+    std::vector<int> touched_windows; // scratch, windows with pending flips
+};
+
+typedef Ranking::SignedRankSum WilcoxResult;
+
+// Buffers used by one thread while recording rank epistasis
+struct RankEpistasisScratch{
+    int cached_org_idx; // organism currently held in delta_state
+    NKDeltaState delta_state;
+    // Scores of the cached organism's single mutants, and their order. Every
+    // focal locus reuses these, moving only the focal locus itself.
+    std::vector<double> single_scores;
+    std::vector<size_t> single_order;
+    std::vector<double> single_scores_full;
+    std::vector<size_t> single_order_full;
+    // Per focal locus: mutant scores without and with the focal mutation
+    std::vector<double> score_original;
+    std::vector<double> score_mutant;
+    std::vector<double> score_original_full;
+    std::vector<double> score_mutant_full;
+    std::vector<size_t> order;
+    std::vector<double> ranks;
+    std::vector<size_t> rank_vec_original;  
+    std::vector<size_t> rank_vec_mutated;  
+    std::vector<int> rank_counts;
+};
+
+// Score of a genotype and summary statistics of its one and two site mutants
+struct MutantFitnessSummary{
     double score_original;
-    double score_mutant;
+    double avg_1;
+    double max_1;
+    double min_1;
+    double avg_2;
+    double max_2;
+    double min_2;
+};
+
+// Totals over (part of) an enumerated landscape
+struct LandscapeSummary{
+    uint64_t genotypes = 0;
+    double sum_score = 0;
+    double max_score = 0;
+    uint64_t max_genotype = 0; // locus n in bit n
+    uint64_t local_optima = 0; // no single mutant scores higher
+    uint64_t strict_local_optima = 0; // every single mutant scores lower
+    uint64_t rank_epistasis_pairs = 0; // (genotype, focal locus) pairs
+    double sum_W = 0;
+    double sum_abs_W = 0;
+    double sum_N_r = 0;
+    uint64_t changed_pairs = 0; // pairs where some rank changed (N_r > 0)
+    // rankEpistasisEvaluation = 2 only: genotypes whose scores, single mutant
+    // scores or rank epistasis differ from full re-evaluation
+    uint64_t mismatches = 0;
+};
+
+// Hash of a packed genome, for maps keyed on genotype
+struct PackedGenomeHash{
+    size_t operator()(const std::vector<uint64_t>& packed) const{
+        return PackedBits::hashWords(packed.data(), packed.size());
+    }
+};
+
+enum RankEpistasisEvaluation{
+    kIncremental = 0,
+    kFullReevaluation = 1,
+    kRegression = 2
+};
+
+enum NKEvaluationMethod{
+    kScalarEvaluation = 0,
+    kBitSliced = 1,
+    kBitSlicedRegression = 2
 };
 
 
@@ -35,11 +116,18 @@ public:
     static std::shared_ptr<ParameterLink<int>> nPL;
     static std::shared_ptr<ParameterLink<int>> kPL;
     static std::shared_ptr<ParameterLink<int>> evaluationsPerGenerationPL;
+    static std::shared_ptr<ParameterLink<int>> evaluationThreadsPL;
+    static std::shared_ptr<ParameterLink<int>> fitnessCacheSizePL;
+    static std::shared_ptr<ParameterLink<int>> evaluationMethodPL;
+    static std::shared_ptr<ParameterLink<bool>> sparseTablesPL;
 
     static std::shared_ptr<ParameterLink<bool>> readNKTablePL;
     static std::shared_ptr<ParameterLink<std::string>> inputNKTableFilenamePL;
     
     static std::shared_ptr<ParameterLink<bool>> writeNKTablePL;
+    static std::shared_ptr<ParameterLink<std::string>> writeNKTableLociPL;
+    static std::shared_ptr<ParameterLink<bool>> hashNKTablePL;
+    static std::shared_ptr<ParameterLink<int>> hashNKTableSeedPL;
 
     static std::shared_ptr<ParameterLink<bool>> treadmillPL;
     static std::shared_ptr<ParameterLink<double>> velocityPL; 
@@ -48,10 +136,17 @@ public:
     static std::shared_ptr<ParameterLink<std::string>> outputRankEpistasisFilenamePL; 
     static std::shared_ptr<ParameterLink<int>> outputRankEpistasisIntervalPL; 
     static std::shared_ptr<ParameterLink<int>> outputEditDistanceMetricPL; 
+    static std::shared_ptr<ParameterLink<int>> rankEpistasisEvaluationPL; 
+    static std::shared_ptr<ParameterLink<double>> rankTieTolerancePL; 
     
     static std::shared_ptr<ParameterLink<bool>> outputMutantFitnessPL; 
     static std::shared_ptr<ParameterLink<std::string>> outputMutantFitnessFilenamePL; 
     static std::shared_ptr<ParameterLink<int>> outputMutantFitnessIntervalPL; 
+
+    static std::shared_ptr<ParameterLink<bool>> outputLandscapePL; 
+    static std::shared_ptr<ParameterLink<std::string>> outputLandscapeFilenamePL; 
+    static std::shared_ptr<ParameterLink<int>> outputLandscapeIntervalPL; 
+    static std::shared_ptr<ParameterLink<bool>> landscapeRankEpistasisPL; 
     
     static std::shared_ptr<ParameterLink<std::string>> groupNamePL;
     static std::shared_ptr<ParameterLink<std::string>> brainNamePL;
@@ -59,22 +154,91 @@ public:
     
     int N;
     int K;
+    bool treadmill;
+    double velocity;
+    int evaluations_per_generation;
+    std::string group_name;
+    std::string brain_name;
+
+    // Parallel evaluation variables
+    std::shared_ptr<ThreadPool> evaluation_pool;
+    std::vector<std::vector<uint64_t>> thread_packed_data;
+    std::vector<double> population_scores;
+
+    // Bit-sliced evaluation: blocks of up to 64 genomes are scored together,
+    // from one word per site with genome j in bit j (see evaluateSlices)
+    int evaluation_method;
+    std::vector<std::vector<uint64_t>> thread_slices; // packed_words * 64 per thread
+    std::vector<std::vector<double>> thread_slice_scores; // 64 per thread
+    std::vector<double> single_mutant_scores; // scratch for summarizeMutants
+    std::vector<double> double_mutant_scores;
+
+    // Genotype fitness cache, keyed on packed brain outputs. Cleared when it
+    // fills up and, if treadmilling, whenever the update changes.
+    int fitness_cache_size; // most genotypes kept, 0 = no cache
+    std::unordered_map<std::vector<uint64_t>, double, PackedGenomeHash> fitness_cache;
+    int fitness_cache_update;
+    int fitness_cache_hits; // lookups this update
+    int fitness_cache_misses;
+    std::vector<double*> evaluation_values; // cache entry for each evaluation
+    std::vector<size_t> pending_evaluations; // evaluations that missed the cache
 
     // Rank Epistasis output variables
     bool output_rank_epistasis;
     std::string output_rank_epistasis_filename;    
     int output_rank_epistasis_interval;
     int edit_distance_metric;
+    int rank_epistasis_evaluation;
+    double rank_tie_tolerance;
     std::stringstream output_string_stream;
-    std::vector<size_t> rank_vec_original;  
-    std::vector<size_t> rank_vec_mutated;  
-    std::vector<RankEpistasisData> mutant_data_vec;  
+    std::vector<RankEpistasisScratch> rank_epistasis_scratch; // one per thread
+    std::vector<uint64_t> population_packed; // packed brain outputs, packed_words per organism
+    std::vector<WilcoxResult> rank_epistasis_results; // one per (org, focal locus)
+    std::vector<WilcoxResult> rank_epistasis_results_full;
     // Mutant fitness variables
     bool output_mutant_fitness;
     std::string output_mutant_fitness_filename;    
     int output_mutant_fitness_interval;
+    // Landscape enumeration variables
+    bool output_landscape;
+    std::string output_landscape_filename;
+    int output_landscape_interval;
+    bool landscape_rank_epistasis;
 
-    std::vector<std::vector<std::pair<double,double>>> NKTable;
+    // NK lookup table, N rows of 2^K (alpha, beta) pairs stored end to end. 
+    // Rows are indexed by a window's bits with the window's first site in 
+    // the lowest bit, the order windows are read out of a packed genome.
+    // Empty if the table is hashed.
+    AlignedVector<std::pair<double,double>> NKTable;
+    // Hashed tables make each entry from this seed when it is read (see 
+    // NKKernels::hashedValue), so N and K are not limited by memory
+    bool hash_nk_table;
+    uint64_t hash_nk_table_seed;
+    // Current local value of every table entry, laid out like NKTable. 
+    // Static landscapes fill it once; treadmilling landscapes refill it 
+    // once per update, so scoring a genome is only N table reads.
+    // Values are kept in fixed point (see NKKernels::toFixed), so sums of
+    // them are exact and scores can be updated by adding differences.
+    AlignedVector<int64_t> localValues;
+    int local_values_update; // update localValues was computed for, -1 if never
+    // A power of 2, as large as leaves room to add N + 2 of the largest local
+    // values (see setFixedScale). Binary fractions of up to log2 of it bits
+    // are kept exactly.
+    double fixed_scale;
+    std::vector<double> triangle_coefficients; // series terms of triangleSin
+    // Packed genomes hold N bits followed by the first K-1 bits again, so 
+    // every window can be read with shifts and no wrap-around
+    int packed_words;
+    // For each locus, the windows containing it and the bits of each
+    // window's table index that flip with it
+    std::vector<std::vector<std::pair<int,int>>> flipWindows;
+    // When every row of localValues is the same and only a few entries are
+    // nonzero, those entries (index, value); otherwise empty. Genomes are 
+    // then scored by finding each pattern at every locus at once.
+    bool sparse_tables;
+    std::vector<std::pair<int,int64_t>> sparse_patterns;
+    // Scoring kernels, specialized for K when our experiments use it
+    NKKernels::Kernels kernels;
 
     NKWorld(std::shared_ptr<ParametersTable> PT_ = nullptr);
     virtual ~NKWorld() = default;
@@ -84,24 +248,59 @@ public:
 
     void recordRankEpistasis(std::map<std::string, std::shared_ptr<Group>> &groups);
     void recordMutantFitness(std::map<std::string, std::shared_ptr<Group>> &groups);
+    void recordLandscape();
+    void packGenotype(uint64_t genotype, uint64_t* packed);
+    void flipPacked(uint64_t* packed, int locus);
+    MutantFitnessSummary summarizeMutants(std::vector<uint64_t>& packed, double score_original);
+
+    // NK table functions
+    size_t tableIndex(int n, int val) const { return ((size_t)n << K) | val; }
+    std::pair<double,double> tableEntry(int n, int val) const;
+    // current local value of a table entry, in fixed point
+    int64_t tableValue(int n, int val) const { 
+        return hash_nk_table ? NKKernels::toFixed(NKKernels::hashedValue(hash_nk_table_seed, 
+                                                                         n, val, 0), fixed_scale)
+                             : localValues[tableIndex(n, val)];
+    }
+    double localValue(int n, int val, double t);
+    void setFixedScale();
+    void updateLocalValues();
+    void writeNKTableFile();
+
+    virtual void saveCheckpoint(Checkpoint::Writer &checkpoint) override;
+    virtual void loadCheckpoint(Checkpoint::Reader &checkpoint) override;
 
     // evaluate functions
-    double evaluateData(const std::vector<uint8_t>& data);
+    void readPacked(std::shared_ptr<AbstractBrain>& brain, uint64_t* packed);
+    double evaluatePacked(const uint64_t* packed);
+    double evaluateWindows(const uint64_t* packed);
+    double evaluateSparse(const uint64_t* packed);
+    NKKernels::Landscape landscape() const {
+        return {N, K, localValues.data(), sparse_patterns.data(), sparse_patterns.size(), 
+                fixed_scale, hash_nk_table_seed};
+    }
+    void findSparsePatterns();
+    bool useSlices() const { 
+        return evaluation_method != kScalarEvaluation && sparse_patterns.empty(); 
+    }
+    void sliceGenomes(const uint64_t* const* genomes, int count, uint64_t* slices);
+    void sliceMutants(const uint64_t* packed, int first_locus, int count, 
+            int focal_locus, uint64_t* slices);
+    void evaluateSlices(const uint64_t* slices, int count, double* scores);
+    void evaluateMutants(const uint64_t* packed, int focal_locus, int first_locus, 
+            double* scores, int thread_id);
+    void evaluateDelta(const uint64_t* packed, NKDeltaState& state);
+    double evaluateFlips(NKDeltaState& state, int locus_a, int locus_b = -1);
+    void commitFlip(NKDeltaState& state, int locus);
     double evaluateBrain(std::shared_ptr<AbstractBrain>& brain);
+    double evaluateBrain(std::shared_ptr<AbstractBrain>& brain, std::vector<uint64_t>& packed);
+    void prepareFitnessCache(size_t incoming);
+    double evaluateCached(std::shared_ptr<AbstractBrain>& brain, std::vector<uint64_t>& packed);
     void evaluateSolo(std::shared_ptr<Organism> org, int analyze, int visualize, int debug);
+    void evaluateParallel(std::vector<std::shared_ptr<Organism>>& population);
    
     virtual void evaluate(std::map<std::string, std::shared_ptr<Group>> &groups,
-                                                int analyze, int visualize, int debug) {
-        int popSize = groups[groupNamePL->get(PT)]->population.size();
-        for (int i = 0; i < popSize; i++) {
-            evaluateSolo(groups[groupNamePL->get(PT)]->population[i], analyze,
-                                     visualize, debug);
-        }
-        if(output_rank_epistasis && Global::update % output_rank_epistasis_interval == 0)
-            recordRankEpistasis(groups);
-        if(output_mutant_fitness && Global::update % output_mutant_fitness_interval == 0)
-            recordMutantFitness(groups);
-    }
+                                                int analyze, int visualize, int debug);
 
     virtual std::unordered_map<std::string, std::unordered_set<std::string>>
     requiredGroups() override {
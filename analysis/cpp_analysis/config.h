@@ -13,7 +13,10 @@ EMP_BUILD_CONFIG(AnalysisConfig,
     VALUE(GEN_END,      size_t,     500,    "Maximum generation to analye (excluded)"),
     VALUE(OUTPUT_FILENAME,          std::string, "edit_distance.csv", "Path to save output file"),
     VALUE(INPUT_FILENAME_PREFIX,    std::string, "./",  "Input filepath up to generation number"),
-    VALUE(INPUT_FILENAME_SUFFIX,    std::string, ".csv","Input filepath after generation number"),
-    VALUE(EDIT_DISTANCE_METRIC,     size_t, 0,   "0 for Levenshtein, 1 for Damerau-Levenshtein")
+    VALUE(INPUT_FILENAME_SUFFIX,    std::string, ".csv","Input filepath after generation number (.csv, or .bin for binary snapshots)"),
+    VALUE(EDIT_DISTANCE_METRIC,     size_t, 0,   "0 for Levenshtein, 1 for Damerau-Levenshtein, 2 for insertions and deletions only, 3 for Levenshtein without bit vectors (for checking 0)"),
+    VALUE(TIE_TOLERANCE,            double, 0.0001, "Scores within this of the lowest score in a group share a rank (0 = exact ties only)"),
+    VALUE(THREADS,                  int,    0,   "Number of worker threads (output does not depend on this), 0 for one per hardware thread"),
+    VALUE(SEED_DIRS_FILENAME,       std::string, "", "File listing seed directories, one per line, to analyze in turn (input and output paths are relative to each); empty for none")
 )
 #endif
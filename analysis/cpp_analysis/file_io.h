@@ -1,67 +1,232 @@
 #ifndef RANK_EPISTASIS_FILE_IO_h
 #define RANK_EPISTASIS_FILE_IO_h
 
-#include <fstream>
+// Standard library
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
 #include <string>
 #include <unordered_set>
-#include <sstream>
-
+#include <vector>
+// POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+// MABE
+#include "../../Utilities/BinarySnapshot.h"
+#include "../../Utilities/PackedBits.h"
+// Local
 #include "organism.h"
 
-// Load in the specified snapshot (should be a .csv)
-//  and add each organism to the passed vector
-// Returns the number of UNIQUE genomes loaded
-size_t LoadOrgsFromSnapshot(std::string filename, std::vector<Organism>& org_vec){
-    std::ifstream fp;
-    std::string line;
-    fp.open(filename, std::ios::in);
-    // If we failed to open file, error out
-    if(!fp.is_open()){
-        std::cerr << "Error! Unable to load snapshot file: " << filename << std::endl;
+// Every genome of a snapshot, bit-packed one after another
+// Site i of an organism is bit i of its words (see Utilities/PackedBits.h),
+//  and the unused bits of its last word are 0
+struct PackedPopulation{
+    size_t genome_length = 0;
+    size_t words_per_org = 0;
+    size_t num_orgs = 0;
+    size_t num_unique_genomes = 0;
+    std::vector<uint64_t> words;
+
+    const uint64_t* GetGenome(size_t org_idx) const{
+        return &words[org_idx * words_per_org];
+    }
+};
+
+// Read-only view of a whole file, mapped into memory
+class MappedFile{
+private:
+    int fd;
+    const char* data;
+    size_t size;
+public:
+    MappedFile(const std::string& filename):
+    fd(-1), data(nullptr), size(0)
+    {
+        fd = open(filename.c_str(), O_RDONLY);
+        struct stat file_stat;
+        if(fd < 0 || fstat(fd, &file_stat) != 0){
+            std::cerr << "Error! Unable to load snapshot file: " << filename << std::endl;
+            exit(-1);
+        }
+        size = file_stat.st_size;
+        if(size == 0) return;
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mapped == MAP_FAILED){
+            std::cerr << "Error! Unable to map snapshot file: " << filename << std::endl;
+            exit(-1);
+        }
+        // Read front to back, once
+        madvise(mapped, size, MADV_SEQUENTIAL);
+        data = (const char*)mapped;
+    }
+    ~MappedFile(){
+        if(data != nullptr) munmap((void*)data, size);
+        if(fd >= 0) close(fd);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    const char* GetData() const{ return data; }
+    size_t GetSize() const{ return size; }
+};
+
+// Hash and equality of organisms by their packed genomes, for counting
+//  unique genomes without building strings
+struct PackedGenomeHash{
+    const PackedPopulation* pop;
+    size_t operator()(size_t org_idx) const{
+        return PackedBits::hashWords(pop->GetGenome(org_idx), pop->words_per_org);
+    }
+};
+struct PackedGenomeEqual{
+    const PackedPopulation* pop;
+    bool operator()(size_t org_a, size_t org_b) const{
+        return std::memcmp(pop->GetGenome(org_a), pop->GetGenome(org_b),
+                pop->words_per_org * sizeof(uint64_t)) == 0;
+    }
+};
+
+// Load in a binary snapshot (see Utilities/BinarySnapshot.h) as packed genomes
+// Genomes must have an alphabet of 2 and all be the same length.
+void LoadPackedBinarySnapshot(const std::string& filename, PackedPopulation& pop){
+    pop = PackedPopulation();
+    BinarySnapshot::Reader reader;
+    std::string error;
+    if(!reader.open(filename, error)){
+        std::cerr << "Error! Unable to load snapshot file " << filename << ": " << error
+                  << std::endl;
+        exit(-1);
+    }
+    const BinarySnapshot::Header& header = reader.getHeader();
+    if(header.bitsPerSite != 1 || header.genomeLength == 0){
+        std::cerr << "Error! Snapshot file " << filename << " does not hold binary genomes!"
+                  << std::endl;
+        exit(-1);
+    }
+    pop.genome_length = header.genomeLength;
+    pop.words_per_org = PackedBits::wordCount(pop.genome_length);
+    pop.words.assign(header.populationSize * pop.words_per_org, 0);
+    PackedGenomeHash hash{&pop};
+    PackedGenomeEqual equal{&pop};
+    std::unordered_set<size_t, PackedGenomeHash, PackedGenomeEqual> unique_genomes(
+            1024, hash, equal);
+    BinarySnapshot::Record record;
+    while(reader.read(record, error)){
+        if(record.siteCount != pop.genome_length){
+            std::cerr << "Error! Genome " << pop.num_orgs << " in snapshot file " << filename
+                      << " has " << record.siteCount << " sites, expected " 
+                      << pop.genome_length << "!" << std::endl;
+            exit(-1);
+        }
+        // Sites are already packed in the same order, a byte at a time
+        uint64_t* genome = &pop.words[pop.num_orgs * pop.words_per_org];
+        for(size_t byte_idx = 0; byte_idx < record.genome.size(); ++byte_idx){
+            genome[byte_idx / 8] |= (uint64_t)record.genome[byte_idx] << (8 * (byte_idx % 8));
+        }
+        unique_genomes.insert(pop.num_orgs);
+        ++pop.num_orgs;
+    }
+    if(error != ""){
+        std::cerr << "Error! Unable to load snapshot file " << filename << ": " << error
+                  << std::endl;
         exit(-1);
     }
-    
-    bool in_genome = false;
-    bool is_organism = false;
-    size_t org_idx = 0;
-    std::vector<unsigned short> cur_genome;
-    std::unordered_set<std::string> genome_set;
-    std::stringstream ss;
-    // Iterate through each line
-    while(getline(fp,line)){
-        if(line == "" || line == "\n")
-            continue;
-        in_genome = false;
-        is_organism = false;
-        for(size_t i = 0; i < line.length(); ++i){
-            if(line[i] == '"'){
-                if(!in_genome){
-                    org_vec.push_back(Organism());
-                    cur_genome.clear(); 
-                    ss.str("");
-                }
-                in_genome = !in_genome;
-                is_organism = true; 
+    pop.num_unique_genomes = unique_genomes.size();
+}
+
+// Load in the specified snapshot (a .csv, or a binary snapshot) as packed genomes
+// The genome of each organism is the first quoted field on its line
+//  (e.g. 200,"0,1,1,0,...",20201); other characters than 0 and 1 in it are skipped.
+// All genomes must be the same length.
+void LoadPackedSnapshot(const std::string& filename, PackedPopulation& pop){
+    if(BinarySnapshot::isBinarySnapshot(filename)){
+        LoadPackedBinarySnapshot(filename, pop);
+        return;
+    }
+    pop = PackedPopulation();
+    MappedFile file(filename);
+    const char* cur = file.GetData();
+    const char* end = cur + file.GetSize();
+    PackedGenomeHash hash{&pop};
+    PackedGenomeEqual equal{&pop};
+    std::unordered_set<size_t, PackedGenomeHash, PackedGenomeEqual> unique_genomes(
+            1024, hash, equal);
+    while(cur < end){
+        const char* field_start = (const char*)std::memchr(cur, '"', end - cur);
+        if(field_start == nullptr) break;
+        ++field_start;
+        const char* field_end = (const char*)std::memchr(field_start, '"', end - field_start);
+        if(field_end == nullptr){
+            std::cerr << "Error! Unterminated genome in snapshot file: " << filename << std::endl;
+            exit(-1);
+        }
+        // The first genome sets the length, and how much room the rest need
+        if(pop.num_orgs == 0){
+            for(const char* c = field_start; c < field_end; ++c){
+                if(*c == '0' || *c == '1') ++pop.genome_length;
             }
-            else if(in_genome){
-                ss << line[i];
-                if(line[i] == '1'){
-                    org_vec[org_idx].PushGene(1);
-                    cur_genome.push_back(1);
-                }
-                else if(line[i] == '0'){
-                    org_vec[org_idx].PushGene(0);
-                    cur_genome.push_back(0);
-                }
+            if(pop.genome_length == 0){
+                std::cerr << "Error! Empty genome in snapshot file: " << filename << std::endl;
+                exit(-1);
             }
-        } 
-        if(is_organism){       
-            ++org_idx;
-            genome_set.insert(ss.str());
+            pop.words_per_org = PackedBits::wordCount(pop.genome_length);
+            size_t line_length = field_end - field_start + 2;
+            pop.words.reserve((file.GetSize() / line_length + 1) * pop.words_per_org);
+        }
+        pop.words.resize((pop.num_orgs + 1) * pop.words_per_org, 0);
+        uint64_t* genome = &pop.words[pop.num_orgs * pop.words_per_org];
+        size_t site = 0;
+        // Genomes written by MABE are single digits between commas, so site i
+        //  is character 2i; anything else is read one character at a time
+        bool plain = (size_t)(field_end - field_start) == 2 * pop.genome_length - 1;
+        for(size_t i = 0; plain && i < pop.genome_length; ++i){
+            char digit = field_start[2 * i];
+            plain = (digit == '0' || digit == '1') && 
+                    (i + 1 == pop.genome_length || field_start[2 * i + 1] == ',');
+            genome[i / 64] |= (uint64_t)(digit == '1') << (i % 64);
+        }
+        if(plain){
+            site = pop.genome_length;
+        }
+        else{
+            std::fill(genome, genome + pop.words_per_org, 0);
+            for(const char* c = field_start; c < field_end; ++c){
+                if(*c != '0' && *c != '1') continue;
+                if(site < pop.genome_length && *c == '1') PackedBits::setBit(genome, site, true);
+                ++site;
+            }
+        }
+        if(site != pop.genome_length){
+            std::cerr << "Error! Genome " << pop.num_orgs << " in snapshot file " << filename
+                      << " has " << site << " sites, expected " << pop.genome_length << "!"
+                      << std::endl;
+            exit(-1);
+        }
+        unique_genomes.insert(pop.num_orgs);
+        ++pop.num_orgs;
+        // Move on to the next line
+        cur = (const char*)std::memchr(field_end, '\n', end - field_end);
+        if(cur == nullptr) break;
+    }
+    pop.num_unique_genomes = unique_genomes.size();
+}
+
+// Load in the specified snapshot (a .csv, or a binary snapshot)
+//  and add each organism to the passed vector
+// Returns the number of UNIQUE genomes loaded
+size_t LoadOrgsFromSnapshot(std::string filename, std::vector<Organism>& org_vec){
+    PackedPopulation pop;
+    LoadPackedSnapshot(filename, pop);
+    for(size_t org_idx = 0; org_idx < pop.num_orgs; ++org_idx){
+        org_vec.push_back(Organism());
+        const uint64_t* genome = pop.GetGenome(org_idx);
+        for(size_t site = 0; site < pop.genome_length; ++site){
+            org_vec.back().PushGene(PackedBits::getBit(genome, site));
         }
     }
-    fp.close();
-    return genome_set.size();
+    return pop.num_unique_genomes;
 }
 
 #endif
@@ -0,0 +1,88 @@
+#ifndef RANK_EPISTASIS_GENERATION_H
+#define RANK_EPISTASIS_GENERATION_H
+
+// Standard library
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+// MABE
+#include "../../Utilities/EditDistance.h"
+#include "../../Utilities/PackedBits.h"
+#include "../../Utilities/Ranking.h"
+// Local
+#include "./file_io.h"
+#include "./nk.h"
+
+// One snapshot (one generation of one seed) and the edit distance of each
+//  locus, which are filled in by separate tasks
+struct GenerationJob{
+    size_t dir_idx;
+    size_t gen;
+    std::string snapshot_filename;
+    PackedPopulation pop;
+    std::vector<double> scores;
+    std::vector<size_t> order;  // organisms in order of score
+    std::vector<double> ranks;  // mid-rank of each organism
+    std::vector<size_t> rank_vec;
+    std::vector<double> edit_distances; // one per locus
+};
+
+// Buffers used by one worker thread while scoring mutants
+struct MutantScratch{
+    std::vector<uint64_t> genome_mutated;
+    std::vector<double> scores_mutated;
+    std::vector<size_t> order_mutated;
+    std::vector<size_t> rank_vec_mutated;
+};
+
+// Load the snapshot, then score and rank the organisms the same way NKWorld
+//  ranks mutants (ranks are truncated mid-ranks, which never collide across ties)
+void PrepareGeneration(GenerationJob& job, size_t N, size_t K, PositionlessNKTable& nk_table,
+        double tie_tolerance){
+    LoadPackedSnapshot(job.snapshot_filename, job.pop);
+    const PackedPopulation& pop = job.pop;
+    // ScoreLocus flips every locus up to N, so the genomes must hold N sites
+    if(pop.genome_length != N){
+        std::cerr << "Error! Genomes in snapshot file " << job.snapshot_filename << " have "
+                  << pop.genome_length << " sites, but N is " << N << "!" << std::endl;
+        exit(-1);
+    }
+    job.scores.resize(pop.num_orgs);
+    for(size_t org_idx = 0; org_idx < pop.num_orgs; ++org_idx){
+        job.scores[org_idx] = ScorePackedGenome(pop.GetGenome(org_idx), pop.genome_length,
+                K, nk_table);
+    }
+    Ranking::stableOrder(job.scores, job.order);
+    Ranking::midRanks(job.scores, job.order, tie_tolerance, job.ranks);
+    job.rank_vec.resize(pop.num_orgs);
+    for(size_t rank_idx = 0; rank_idx < pop.num_orgs; ++rank_idx){
+        job.rank_vec[rank_idx] = job.ranks[job.order[rank_idx]];
+    }
+    job.edit_distances.assign(N, 0);
+}
+
+// Mutate locus_idx in every organism, order the mutants (keeping the original
+//  order among equal scores) and record the edit distance between the rank vectors
+void ScoreLocus(GenerationJob& job, size_t locus_idx, size_t K, PositionlessNKTable& nk_table,
+        EditDistanceMetric edit_distance_metric, MutantScratch& scratch){
+    const PackedPopulation& pop = job.pop;
+    scratch.scores_mutated.resize(pop.num_orgs);
+    scratch.rank_vec_mutated.resize(pop.num_orgs);
+    for(size_t org_idx = 0; org_idx < pop.num_orgs; ++org_idx){
+        const uint64_t* genome = pop.GetGenome(org_idx);
+        scratch.genome_mutated.assign(genome, genome + pop.words_per_org);
+        PackedBits::flipBit(scratch.genome_mutated.data(), locus_idx);
+        scratch.scores_mutated[org_idx] = ScorePackedGenome(scratch.genome_mutated.data(),
+                pop.genome_length, K, nk_table);
+    }
+    scratch.order_mutated = job.order;
+    Ranking::reorder(scratch.scores_mutated, scratch.order_mutated);
+    for(size_t rank_idx = 0; rank_idx < pop.num_orgs; ++rank_idx){
+        scratch.rank_vec_mutated[rank_idx] = job.ranks[scratch.order_mutated[rank_idx]];
+    }
+    job.edit_distances[locus_idx] = EditDistance(job.rank_vec, scratch.rank_vec_mutated,
+            edit_distance_metric);
+}
+
+#endif
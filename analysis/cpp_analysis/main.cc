@@ -2,6 +2,8 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <fstream>
+#include <sstream>
 // Empirical
 #include "config/ArgManager.h"
 #include "config/command_line.h"
@@ -9,20 +11,13 @@
 #include "./organism.h"
 #include "./file_io.h"
 #include "./nk.h"
-#include "./edit_distance.h"
+#include "./generation.h"
 #include "./config.h"
+// MABE
+#include "../../Utilities/EditDistance.h"
+#include "../../Utilities/Ranking.h"
+#include "../../Utilities/ThreadPool.h"
 
-void RankOrgs(std::vector<Organism>& orgs){
-    for(size_t org_idx = 0; org_idx < orgs.size(); ++org_idx){
-        orgs[org_idx].SetID(org_idx);
-    }
-}
-
-void SortOrgs(std::vector<Organism>& orgs){
-    std::stable_sort(orgs.begin(), orgs.end(), [](const Organism& org_a, const Organism& org_b){
-        return org_a.GetScore() < org_b.GetScore();
-    });
-}
 // Run a few known examples to check output 
 void SanityCheck(){
     // To compare against https://en.wikipedia.org/wiki/Levenshtein_distance
@@ -38,6 +33,26 @@ void SanityCheck(){
     std::cout << "Distance: " << dist << std::endl;
 }
 
+// Read the seed directories to analyze, one per line (like dirs_to_scrape.txt),
+//  each returned with a trailing '/'. Blank lines and lines starting with '#'
+//  are skipped. With no file, the input and output paths are used as they are.
+std::vector<std::string> LoadSeedDirs(const std::string& filename){
+    if(filename == "") return {""};
+    std::ifstream fp(filename);
+    if(!fp.is_open()){
+        std::cerr << "Unable to open seed directory list: " << filename << std::endl;
+        exit(-1);
+    }
+    std::vector<std::string> dirs;
+    std::string line;
+    while(getline(fp, line)){
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if(line == "" || line[0] == '#') continue;
+        if(line.back() != '/') line += '/';
+        dirs.push_back(line);
+    }
+    return dirs;
+}
 
 int main(int argc, char* argv[]){
     const std::string config_filename = "analysis_config.cfg";
@@ -59,6 +74,9 @@ int main(int argc, char* argv[]){
     const std::string input_filename_suffix =   (std::string)   config.INPUT_FILENAME_SUFFIX();
     const size_t edit_distance_metric_tmp =     (size_t)        config.EDIT_DISTANCE_METRIC();
     const EditDistanceMetric edit_distance_metric = (EditDistanceMetric)edit_distance_metric_tmp;
+    const double tie_tolerance =                (double)        config.TIE_TOLERANCE();
+    const int num_threads =                     (int)           config.THREADS();
+    const std::string seed_dirs_filename =      (std::string)   config.SEED_DIRS_FILENAME();
     // Write to screen how the experiment is configured
     std::cout << "==============================" << std::endl;
     std::cout << "|    Current configuration   |" << std::endl;
@@ -67,15 +85,6 @@ int main(int argc, char* argv[]){
     std::cout << "==============================\n" << std::endl;
  
      
-    // Attempt to open the output file
-    std::ofstream fp_out;
-    fp_out.open(output_filename, std::ios::out);
-    if(!fp_out.is_open()){
-        std::cerr << "Unable to open output file: " << output_filename << std::endl;
-        exit(-1);
-    }
-    fp_out << "gen,locus,edit_distance,weighted_edit_distance\n";
-    
     // Setup desired NK table
     PositionlessNKTable nk_table(K);
     nk_table.SetValue(BinaryVecToInteger({1,1,1}), 1);
@@ -85,66 +94,80 @@ int main(int argc, char* argv[]){
     std::cout << "Using the following NK table:" << std::endl;
     nk_table.Print();
     
-    std::vector<Organism> orgs;
-    std::stringstream ss;
-    for(size_t gen = gen_start; gen < gen_end; ++gen){
-        // Load snapshot file
-        orgs.clear();
-        ss.str("");
-        ss << input_filename_prefix << gen << input_filename_suffix;
-        size_t num_unique_genomes = LoadOrgsFromSnapshot(ss.str(), orgs); 
-        
-        std::cout 
-            << gen << " "
-            << "(" << num_unique_genomes << " / " 
-            << orgs.size() << " )" 
-            << std::endl;
-        
-        // Score the organisms
-        for(size_t org_idx = 0; org_idx < orgs.size(); ++org_idx){
-            orgs[org_idx].Score(K, nk_table);
-        }
-        // Sort the organisms based on score and then label them
-        SortOrgs(orgs);
-        RankOrgs(orgs);
- 
-        // Extract ranks 
-        std::vector<size_t> rank_vec(orgs.size(), 0);
-        std::vector<size_t> rank_vec_mutated(orgs.size(), 0);
-        for(size_t org_idx = 0; org_idx < orgs.size(); ++org_idx){
-            rank_vec[org_idx] = orgs[org_idx].GetID();
-        }
-
-        // Create a genome_weighting_factor, num. unique genomes / num. total genomes
-        double genome_weighting_factor = ((double)num_unique_genomes) / orgs.size(); 
+    // Every (seed directory, generation) pair is one job, analyzed in this order
+    std::vector<std::string> seed_dirs = LoadSeedDirs(seed_dirs_filename);
+    size_t gens_per_dir = gen_end > gen_start ? gen_end - gen_start : 0;
+    size_t num_jobs = seed_dirs.size() * gens_per_dir;
+    auto make_job = [&](size_t job_idx, GenerationJob& job){
+        job.dir_idx = job_idx / gens_per_dir;
+        job.gen = gen_start + job_idx % gens_per_dir;
+        std::stringstream ss;
+        ss << seed_dirs[job.dir_idx] << input_filename_prefix << job.gen << input_filename_suffix;
+        job.snapshot_filename = ss.str();
+    };
 
-        double edit_distance = 0;
-        // Create, score, and sort some mutated organisms
-        std::vector<Organism> orgs_mutated(orgs.size());
-        for(size_t locus_idx = 0; locus_idx < N; ++locus_idx){ 
-            for(size_t org_idx = 0; org_idx < orgs.size(); ++org_idx){
-                orgs_mutated[org_idx] = orgs[org_idx].GetMutatedCopy(locus_idx);
-                orgs_mutated[org_idx].Score(K, nk_table);
+    // Jobs go through in batches. Each pass over the thread pool scores every
+    //  (generation, locus) of the current batch while loading and ranking the
+    //  next batch; the current batch is then written out in order, so the output
+    //  does not depend on the number of threads.
+    ThreadPool pool(num_threads);
+    std::vector<MutantScratch> thread_scratch(pool.size());
+    const size_t batch_size = 2 * pool.size();
+    std::vector<GenerationJob> batch, next_batch;
+    std::ofstream fp_out;
+    size_t open_dir_idx = seed_dirs.size();
+    size_t next_job_idx = 0;
+    auto fill_batch = [&](std::vector<GenerationJob>& jobs){
+        jobs.resize(std::min(batch_size, num_jobs - next_job_idx));
+        for(auto& job : jobs) make_job(next_job_idx++, job);
+    };
+    fill_batch(batch);
+    pool.parallelFor(batch.size(), [&](long long job_idx, int thread_id){
+        PrepareGeneration(batch[job_idx], N, K, nk_table, tie_tolerance);
+    });
+    while(!batch.empty()){
+        fill_batch(next_batch);
+        pool.parallelFor(next_batch.size() + batch.size() * N, [&](long long task_idx, int thread_id){
+            if(task_idx < (long long)next_batch.size()){
+                PrepareGeneration(next_batch[task_idx], N, K, nk_table, tie_tolerance);
+                return;
+            }
+            task_idx -= next_batch.size();
+            ScoreLocus(batch[task_idx / N], task_idx % N, K, nk_table, edit_distance_metric, 
+                    thread_scratch[thread_id]);
+        });
+        for(const GenerationJob& job : batch){
+            if(job.dir_idx != open_dir_idx){
+                // Attempt to open the output file
+                if(fp_out.is_open()) fp_out.close();
+                std::string filename = seed_dirs[job.dir_idx] + output_filename;
+                fp_out.open(filename, std::ios::out);
+                if(!fp_out.is_open()){
+                    std::cerr << "Unable to open output file: " << filename << std::endl;
+                    exit(-1);
+                }
+                fp_out << "gen,locus,edit_distance,weighted_edit_distance\n";
+                if(seed_dirs[job.dir_idx] != "") std::cout << seed_dirs[job.dir_idx] << std::endl;
+                open_dir_idx = job.dir_idx;
             }
-            SortOrgs(orgs_mutated);
-            for(size_t org_idx = 0; org_idx < orgs.size(); ++org_idx){
-                rank_vec_mutated[org_idx] = orgs_mutated[org_idx].GetID();
+            size_t num_unique_genomes = job.pop.num_unique_genomes;
+            std::cout 
+                << job.gen << " "
+                << "(" << num_unique_genomes << " / " 
+                << job.pop.num_orgs << " )" 
+                << std::endl;
+            // Create a genome_weighting_factor, num. unique genomes / num. total genomes
+            double genome_weighting_factor = ((double)num_unique_genomes) / job.pop.num_orgs; 
+            for(size_t locus_idx = 0; locus_idx < N; ++locus_idx){ 
+                double edit_distance = job.edit_distances[locus_idx];
+                fp_out << job.gen << ","
+                    << locus_idx << ","
+                    << edit_distance << ","
+                    << edit_distance * genome_weighting_factor << "\n";
             }
-            //std::cout << "mutants (" << gen << "," << locus_idx << ") " << std::endl;
-            //for (int i = 0; i < orgs.size(); i++) {
-            //    std::cout << "[" << rank_vec_mutated[i] << "]"
-            //        << orgs_mutated[i].GetScore() / N << " ";
-            //}        
-            //std::cout << std::endl;
-            edit_distance = EditDistance(rank_vec, rank_vec_mutated, edit_distance_metric);
-            fp_out << gen << ","
-                << locus_idx << ","
-                << edit_distance << ","
-                << edit_distance * genome_weighting_factor << "\n";
-            //std::cout << "edit distance (" << gen << "," << locus_idx << ") " << edit_distance
-            //    << std::endl; 
         }
+        std::swap(batch, next_batch);
     }
-    fp_out.close();
+    if(fp_out.is_open()) fp_out.close();
     return 0;
 }
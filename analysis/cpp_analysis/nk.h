@@ -4,6 +4,8 @@
 #include <vector>
 #include <iostream>
 #include <iomanip>
+// MABE
+#include "../../Utilities/PackedBits.h"
 
 size_t BinaryVecToInteger(std::vector<unsigned short> vec){
     size_t return_val = 0;
@@ -58,5 +60,25 @@ public:
     }
 };
 
+// Score of a bit-packed genome (see Utilities/PackedBits.h) of genome_length
+//  sites, the same as Organism::Score: the sum of the table values of every
+//  window of K sites, wrapping around the end of the genome
+double ScorePackedGenome(const uint64_t* genome, size_t genome_length, size_t K, 
+        PositionlessNKTable& nk_table){
+    double score = 0;
+    for(size_t idx = 0; idx < genome_length; ++idx){
+        size_t gene = 0;
+        if(idx + K <= genome_length){
+            gene = PackedBits::readBits(genome, idx, K);
+        }
+        else{
+            for(size_t k = 0; k < K; ++k){
+                gene |= (size_t)PackedBits::getBit(genome, (idx + k) % genome_length) << k;
+            }
+        }
+        score += nk_table.GetValue(gene);
+    }
+    return score;
+}
 
 #endif
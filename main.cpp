@@ -14,9 +14,11 @@
 #include "Group/Group.h"
 #include "Organism/Organism.h"
 #include "Utilities/Utilities.h"
+#include "Utilities/Checkpoint.h"
 #include "Utilities/Data.h"
 #include "Utilities/Loader.h"
 #include "Utilities/MTree.h"
+#include "Utilities/ObjectPool.h"
 #include "Utilities/Parameters.h"
 #include "Utilities/Random.h"
 #include "Utilities/Utilities.h"
@@ -40,9 +42,11 @@ volatile sig_atomic_t userExitFlag = 0;
 void catchCtrlC(int signalID) {
   if (userExitFlag==1) {
       printf("Early termination requested. Results may be incomplete.\n");
+      FileManager::requestFlush(2.0); // give buffered output a chance to land
       raise(SIGTERM);
   }
   userExitFlag = 1;
+  FileManager::requestFlush();
   printf("\nQuitting after current update. (ctrl-c again to force quit)\n");
 }
 
@@ -50,6 +54,13 @@ std::map<std::string, std::shared_ptr<Group>>
 constructAllGroupsFrom(const std::shared_ptr<AbstractWorld> &world,
                        std::shared_ptr<ParametersTable> PT);
 
+void saveCheckpoint(const std::string &fileName,
+                    const std::shared_ptr<AbstractWorld> &world,
+                    std::map<std::string, std::shared_ptr<Group>> &groups);
+void loadCheckpoint(const std::string &fileName,
+                    const std::shared_ptr<AbstractWorld> &world,
+                    std::map<std::string, std::shared_ptr<Group>> &groups);
+
 int main(int argc, const char *argv[]) {
   signal(SIGINT, catchCtrlC);
 
@@ -120,6 +131,8 @@ int main(int argc, const char *argv[]) {
     exit(1);
   }
   FileManager::outputPrefix = output_prefix;
+  FileManager::bufferSize = std::max(0, Global::outputBufferSizePL->get());
+  ObjectPools::enabled() = Global::poolObjectsPL->get();
 
   // set up random number generator
   if (Global::randomSeedPL->get() == -1) {
@@ -149,6 +162,12 @@ int main(int argc, const char *argv[]) {
 
   Global::update = 0;
 
+  if (!Global::resumeFromPL->get().empty()) {
+    loadCheckpoint(Global::resumeFromPL->get(), world, groups);
+  }
+  int checkpointInterval = Global::checkpointIntervalPL->get();
+  std::string poolCountsFile = Global::poolCountsFilePL->get();
+
 
   if (Global::modePL->get() == "run") {
     ////////////////////////////////////////////////////////////////////////////////////
@@ -165,6 +184,9 @@ int main(int argc, const char *argv[]) {
                       AbstractWorld::debugPL->get()); // evaluate each organism
                                                       // in the population using
                                                       // a World
+      if (AbstractWorld::debugPL->get()) {
+        ParameterBindings::checkAll();
+      }
       std::cout << "update: " << Global::update << "   " << std::flush;
       done = true; // until we find out otherwise, assume we are done.
       for (auto const &group : groups) {
@@ -177,9 +199,21 @@ int main(int argc, const char *argv[]) {
           }
           group.second->optimizer->cleanup(group.second->population);
         }
+      }
+      ObjectPools::endUpdate();
+      if (!poolCountsFile.empty()) {
+        DataMap poolCounts;
+        poolCounts.set("update", Global::update);
+        ObjectPools::record(poolCounts);
+        poolCounts.writeToFile(poolCountsFile);
       }
 	  std::cout << std::endl;
       Global::update++; // advance time to create new population(s)
+
+      if (!done && checkpointInterval > 0 &&
+          (Global::update % checkpointInterval == 0 || userExitFlag)) {
+        saveCheckpoint(Global::checkpointFilePL->get(), world, groups);
+      }
     }
 
     // the run is finished... flush any data that has not been output yet
@@ -356,12 +390,18 @@ constructAllGroupsFrom(const std::shared_ptr<AbstractWorld> &world,
 
     std::vector<std::shared_ptr<Organism>> population;
 
-    auto file_to_load = Global::initPopPL->get(PT);
+    // a run resumed from a checkpoint gets its population from the
+    // checkpoint, once the group is built (see loadCheckpoint)
+    bool resuming = !Global::resumeFromPL->get().empty();
+    std::vector<std::pair<OrgID, OrgAttributesMap>> orgs_to_load;
     Loader loader;
-    auto orgs_to_load = loader.loadPopulation(file_to_load);
+    if (!resuming) {
+      auto file_to_load = Global::initPopPL->get(PT);
+      orgs_to_load = loader.loadPopulation(file_to_load);
+    }
     int population_size = orgs_to_load.size();
 
-    if (!population_size) {
+    if (!population_size && !resuming) {
       std::cout << "error: MASTER must contain at least one organism"
                 << std::endl;
       exit(1);
@@ -377,7 +417,15 @@ constructAllGroupsFrom(const std::shared_ptr<AbstractWorld> &world,
           newGenomes[genome.first] = genome.second->makeLike();
         } else { // if this file is loaded ...
           auto name = genome.first;
-          genome.second->deserialize(genome.second->PT, orgData.second, name);
+          auto const &site_values = loader.getSiteValues(orgData.first);
+          auto found = site_values.find(name);
+          if (found == site_values.end()) {
+            genome.second->deserialize(genome.second->PT, orgData.second, name);
+          } else if (!genome.second->setSiteValues(found->second)) {
+            std::cout << "error: genome " << name << " can not be loaded from a "
+                      << "binary snapshot (its sites are not integers)" << std::endl;
+            exit(1);
+          }
           newGenomes[genome.first] = genome.second;
         }
       }
@@ -492,3 +540,185 @@ constructAllGroupsFrom(const std::shared_ptr<AbstractWorld> &world,
   }
   return groups;
 }
+
+// write the state of a run in run mode to fileName (in the output directory):
+// the update, organism IDs and random number generator, the output files
+// written so far, the world's state, and every organism in every group
+void saveCheckpoint(const std::string &fileName,
+                    const std::shared_ptr<AbstractWorld> &world,
+                    std::map<std::string, std::shared_ptr<Group>> &groups) {
+  Checkpoint::Writer checkpoint;
+  std::string path = FileManager::outputPrefix + fileName;
+  if (!checkpoint.open(path)) {
+    std::cout << "  ERROR :: could not open checkpoint file " << path
+              << " for writing. Exiting." << std::endl;
+    exit(1);
+  }
+  checkpoint.put((int32_t)Global::update);
+  checkpoint.put((int32_t)Organism::getIDCounter());
+  std::stringstream generatorState;
+  generatorState << Random::getCommonGenerator();
+  checkpoint.put(generatorState.str());
+
+  FileManager::saveCheckpoint(checkpoint);
+  world->saveCheckpoint(checkpoint);
+
+  checkpoint.put((uint64_t)groups.size());
+  for (auto const &group : groups) {
+    checkpoint.put(group.first);
+    auto &population = group.second->population;
+    checkpoint.put((uint64_t)population.size());
+    for (auto const &org : population) {
+      checkpoint.put((int32_t)org->ID);
+      checkpoint.put((int32_t)org->timeOfBirth);
+      org->dataMap.saveCheckpoint(checkpoint);
+      checkpoint.put(std::vector<int>(org->ancestors.begin(),
+                                      org->ancestors.end()));
+      checkpoint.put(std::vector<int>(org->snapshotAncestors.begin(),
+                                      org->snapshotAncestors.end()));
+      // genomes and brains are saved the same way as in snapshot files
+      std::vector<std::string> keys, values;
+      auto addSerialized = [&keys, &values](DataMap serialized) {
+        for (auto const &key : serialized.getKeys()) {
+          keys.push_back(key);
+          values.push_back(serialized.getStringOfVector(key));
+        }
+      };
+      for (auto const &genome : org->genomes) {
+        std::string name = "GENOME_" + genome.first;
+        addSerialized(genome.second->serialize(name));
+      }
+      for (auto const &brain : org->brains) {
+        std::string name = "BRAIN_" + brain.first;
+        addSerialized(brain.second->serialize(name));
+      }
+      checkpoint.put(keys);
+      checkpoint.put(values);
+      for (auto const &genome : org->genomes) {
+        checkpoint.put(genome.first);
+        genome.second->saveCheckpoint(checkpoint);
+      }
+    }
+  }
+
+  if (!checkpoint.close()) {
+    std::cout << "  ERROR :: could not write checkpoint file " << path
+              << ". Exiting." << std::endl;
+    exit(1);
+  }
+  std::cout << "  checkpoint written to " << path << std::endl;
+}
+
+// restore the state written by saveCheckpoint into a newly built world and
+// groups (whose populations are empty)
+void loadCheckpoint(const std::string &fileName,
+                    const std::shared_ptr<AbstractWorld> &world,
+                    std::map<std::string, std::shared_ptr<Group>> &groups) {
+  Checkpoint::Reader checkpoint;
+  if (!checkpoint.open(fileName)) {
+    std::cout << "  ERROR :: " << fileName
+              << " could not be opened or is not a checkpoint file. Exiting."
+              << std::endl;
+    exit(1);
+  }
+  for (auto const &group : groups) {
+    if (DefaultArchivist::Arch_outputMethodStrPL->get(
+            group.second->archivist->PT) != "Default") {
+      std::cout << "  ERROR :: runs can only be resumed from a checkpoint with "
+                   "ARCHIVIST-outputMethod = Default. Exiting."
+                << std::endl;
+      exit(1);
+    }
+  }
+  std::cout << "\nResuming from checkpoint " << fileName << std::endl;
+
+  int32_t update, nextID;
+  std::string generatorState;
+  checkpoint.get(update);
+  checkpoint.get(nextID);
+  checkpoint.get(generatorState);
+
+  FileManager::loadCheckpoint(checkpoint);
+  world->loadCheckpoint(checkpoint);
+
+  uint64_t groupCount = checkpoint.getSize(1);
+  for (uint64_t g = 0; g < groupCount && checkpoint.ok(); g++) {
+    std::string groupName;
+    checkpoint.get(groupName);
+    if (groups.find(groupName) == groups.end()) {
+      std::cout << "  ERROR :: checkpoint has group \"" << groupName
+                << "\", which this run does not have. Exiting." << std::endl;
+      exit(1);
+    }
+    auto &group = groups[groupName];
+    auto &templateOrg = group->templateOrg;
+    uint64_t populationSize = checkpoint.getSize(1);
+    for (uint64_t i = 0; i < populationSize && checkpoint.ok(); i++) {
+      int32_t ID, timeOfBirth;
+      checkpoint.get(ID);
+      checkpoint.get(timeOfBirth);
+      DataMap dataMap;
+      dataMap.loadCheckpoint(checkpoint);
+      std::vector<int> ancestors, snapshotAncestors;
+      checkpoint.get(ancestors);
+      checkpoint.get(snapshotAncestors);
+      std::vector<std::string> keys, values;
+      checkpoint.get(keys);
+      checkpoint.get(values);
+      if (!checkpoint.ok() || keys.size() != values.size()) {
+        break;
+      }
+
+      // rebuild genomes and brains the same way a loaded population is built
+      std::unordered_map<std::string, std::string> orgData;
+      for (size_t k = 0; k < keys.size(); k++) {
+        orgData[keys[k]] = values[k];
+      }
+      std::unordered_map<std::string, std::shared_ptr<AbstractGenome>> newGenomes;
+      std::unordered_map<std::string, std::shared_ptr<AbstractBrain>> newBrains;
+      for (auto const &genome : templateOrg->genomes) {
+        auto name = genome.first;
+        newGenomes[name] = genome.second->makeLike();
+        newGenomes[name]->deserialize(genome.second->PT, orgData, name);
+      }
+      for (size_t g = 0; g < newGenomes.size() && checkpoint.ok(); g++) {
+        std::string name;
+        checkpoint.get(name);
+        if (checkpoint.ok() && newGenomes.find(name) == newGenomes.end()) {
+          std::cout << "  ERROR :: checkpoint has genome \"" << name
+                    << "\", which this run does not have. Exiting."
+                    << std::endl;
+          exit(1);
+        }
+        newGenomes[name]->loadCheckpoint(checkpoint);
+      }
+      for (auto const &brain : templateOrg->brains) {
+        auto name = brain.first;
+        newBrains[name] = brain.second->makeBrain(newGenomes);
+        newBrains[name]->deserialize(brain.second->PT, orgData, name);
+      }
+      auto org = std::make_shared<Organism>(templateOrg, newGenomes, newBrains,
+                                            templateOrg->PT);
+      org->ID = ID;
+      org->timeOfBirth = timeOfBirth;
+      org->dataMap = dataMap;
+      org->ancestors = std::unordered_set<int>(ancestors.begin(), ancestors.end());
+      org->snapshotAncestors = std::unordered_set<int>(snapshotAncestors.begin(),
+                                                       snapshotAncestors.end());
+      group->population.push_back(org);
+    }
+  }
+  if (!checkpoint.ok()) {
+    std::cout << "  ERROR :: checkpoint file " << fileName
+              << " is truncated. Exiting." << std::endl;
+    exit(1);
+  }
+
+  // restored last, since building organisms draws random numbers
+  Global::update = update;
+  Organism::setIDCounter(nextID);
+  std::stringstream(generatorState) >> Random::getCommonGenerator();
+  std::cout << "  resuming at update " << update << " with "
+            << groups.begin()->second->population.size() << " organisms"
+            << std::endl;
+}
@@ -0,0 +1,56 @@
+#!/bin/bash
+# Runs NKWorld in its regression modes (evaluationMethod 2 and
+# rankEpistasisEvaluation 2, which also checks the landscape for small N) on
+# tables that have caught differences between scoring paths before. Each mode
+# exits with an error if two paths disagree.
+# Run from the directory holding mabe, the settings files and nk_tables:
+#   bash scripts/check_nk_regression.sh [updates]
+
+UPDATES=${1:-100}
+MABE=./mabe
+OUT=$(mktemp -d nk_regression.XXXXXX) # outputPrefix is relative
+trap 'rm -rf "$OUT"' EXIT
+
+# n k table (- = random table, hashed = hashed random table) [tie tolerance]
+CASES=(
+  "60 6 nk_tables/fit_flat_6_alt.dat"  # values are not binary fractions
+  "60 6 nk_tables/fit_flat_6_alt.dat 0"
+  "60 6 nk_tables/fit_flat_6.dat"
+  "60 3 nk_tables/fit_flat_3.dat"
+  "60 4 -"
+  "60 4 hashed"
+  "14 6 nk_tables/fit_flat_6_alt.dat"  # small enough to enumerate the landscape
+  # mostly equal values, so most mutants tie
+  "8 2 nk_tables/table_luck.dat"
+  "8 2 nk_tables/table_luck.dat 0"
+  "8 2 nk_tables/table_luck2.dat 0"
+  "4 2 nk_tables/table_ones.dat 0"
+)
+
+failed=0
+for case in "${CASES[@]}"; do
+  read -r n k table tolerance <<< "$case"
+  tolerance=${tolerance:-0.0001}
+  if [ "$table" = "-" ]; then
+    table_args="WORLD_NK-readNKTable 0"
+  elif [ "$table" = "hashed" ]; then
+    table_args="WORLD_NK-readNKTable 0 WORLD_NK-hashNKTable 1"
+  else
+    table_args="WORLD_NK-readNKTable 1 WORLD_NK-inputNKTableFilename $table"
+  fi
+  if "$MABE" -f settings.cfg settings_organism.cfg settings_world.cfg -p \
+      GLOBAL-updates "$UPDATES" GLOBAL-outputPrefix "$OUT/" \
+      WORLD_NK-n "$n" WORLD_NK-k "$k" $table_args \
+      WORLD_NK-evaluationMethod 2 \
+      WORLD_NK_OUTPUT-outputLandscape $([ "$n" -le 16 ] && echo 1 || echo 0) \
+      WORLD_NK_OUTPUT-outputRankEpistasis 1 \
+      WORLD_NK_OUTPUT-rankEpistasisEvaluation 2 \
+      WORLD_NK_OUTPUT-rankTieTolerance "$tolerance" > "$OUT/log" 2>&1; then
+    echo "ok     n=$n k=$k $table tolerance=$tolerance"
+  else
+    echo "FAILED n=$n k=$k $table tolerance=$tolerance"
+    grep -m 5 -i "mismatch\|error" "$OUT/log"
+    failed=1
+  fi
+done
+exit $failed